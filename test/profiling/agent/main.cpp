@@ -13,15 +13,88 @@
 // limitations under the License.
 
 #include <uxr/agent/transport/udp/UDPv4AgentLinux.hpp>
+#include <uxr/agent/transport/tcp/TCPv4AgentLinux.hpp>
 
-int main()
+#ifdef UXR_PROFILING_FOOTPRINT
+#include <footprint.hpp>
+#endif
+
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+volatile std::sig_atomic_t running = 1;
+volatile std::sig_atomic_t report_requested = 0;
+
+void on_signal(int)
+{
+    running = 0;
+}
+
+void on_report(int)
+{
+    report_requested = 1;
+}
+
+void report()
 {
-    eprosima::uxr::UDPv4Agent agent(2020, eprosima::uxr::Middleware::Kind::CED);
-    agent.start();
+#ifdef UXR_PROFILING_FOOTPRINT
+    footprint::print_json(std::cerr);
+    std::cerr << std::endl;
+#endif
+}
 
-    while (true) {
+template<typename AgentType>
+int run(AgentType& agent)
+{
+    if (!agent.start())
+    {
+        std::cerr << "Error at start agent." << std::endl;
+        return 1;
+    }
+
+    while (running) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (report_requested)
+        {
+            report_requested = 0;
+            report();
+        }
     }
 
+    agent.stop();
+    report();
     return 0;
-}
\ No newline at end of file
+}
+
+} // namespace
+
+int main(int args, char** argv)
+{
+    // CLI: [udp|tcp] [port], defaults to UDP on port 2020.
+    const char* transport = (1 < args) ? argv[1] : "udp";
+    uint16_t port = (2 < args) ? uint16_t(std::atoi(argv[2])) : uint16_t(2020);
+
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+    std::signal(SIGUSR1, on_report);
+
+    if (0 == std::strcmp(transport, "udp"))
+    {
+        eprosima::uxr::UDPv4Agent agent(port, eprosima::uxr::Middleware::Kind::CED);
+        return run(agent);
+    }
+    else if (0 == std::strcmp(transport, "tcp"))
+    {
+        eprosima::uxr::TCPv4Agent agent(port, eprosima::uxr::Middleware::Kind::CED);
+        return run(agent);
+    }
+
+    std::cerr << "usage: [udp|tcp] [port]" << std::endl;
+    return 1;
+}
@@ -0,0 +1,89 @@
+import json
+import signal
+import subprocess
+import sys
+import time
+from tabulate import tabulate
+
+n_pubsub = [1, 1 << 1, 1 << 2, 1 << 3]
+topic_size = [1 << 4, 1 << 6, 1 << 8]
+stream_kind = ["best_effort", "reliable"]
+mode = ["throughput", "ping"]
+samples = 10000
+ping_samples = 1000
+output_file = sys.argv[1] if len(sys.argv) > 1 else "benchmark-results.json"
+
+results = []
+
+for m in mode:
+    for s in stream_kind:
+        for t in topic_size:
+            for n in n_pubsub:
+                agent_sp = subprocess.Popen(["./install/bin/agent-profiling"], shell=False)
+                time.sleep(1)
+
+                count = ping_samples if m == "ping" else samples
+                client_key = 1
+                sub_sps = []
+                pub_sps = []
+                for i in range(n):
+                    sub_sps.append(subprocess.Popen(
+                        ["./install/bin/subscriber-benchmark", str(client_key), "topic_name_{}".format(i), str(count), s, m],
+                        stdout=subprocess.PIPE, universal_newlines=True))
+                    client_key += 1
+                time.sleep(1)
+
+                for i in range(n):
+                    pub_sps.append(subprocess.Popen(
+                        ["./install/bin/publisher-benchmark", str(client_key), "topic_name_{}".format(i), str(t), str(count), s, m],
+                        stdout=subprocess.PIPE, universal_newlines=True))
+                    client_key += 1
+
+                reports = []
+                for sp in pub_sps + sub_sps:
+                    out, _ = sp.communicate()
+                    for line in out.splitlines():
+                        if line.startswith("{"):
+                            reports.append(json.loads(line))
+
+                agent_sp.send_signal(signal.SIGINT)
+                agent_sp.wait()
+
+                pubs = [r for r in reports if r["role"] == "publisher"]
+                subs = [r for r in reports if r["role"] == "subscriber"]
+                results.append({
+                    "mode": m,
+                    "stream": s,
+                    "topic_size": t,
+                    "n_pubsub": n,
+                    "publishers": pubs,
+                    "subscribers": subs,
+                })
+
+with open(output_file, "w") as f:
+    json.dump(results, f, indent=2)
+
+table = []
+for r in results:
+    pubs = r["publishers"]
+    subs = r["subscribers"]
+    if not pubs or not subs:
+        table.append([r["mode"], r["stream"], r["topic_size"], r["n_pubsub"], "error"])
+        continue
+    latency_key = "rtt_ns" if r["mode"] == "ping" else "latency_ns"
+    latencies = [p[latency_key] for p in pubs] if r["mode"] == "ping" else [x[latency_key] for x in subs]
+    table.append([
+        r["mode"],
+        r["stream"],
+        r["topic_size"],
+        r["n_pubsub"],
+        round(sum(x["msgs_per_sec"] for x in subs), 1),
+        round(sum(x["bytes_per_sec"] for x in subs) / 1000, 2),
+        sum(x["lost"] for x in subs),
+        round(max(x["p50"] for x in latencies) / 1000, 1),
+        round(max(x["p99"] for x in latencies) / 1000, 1),
+        round(max(x["p999"] for x in latencies) / 1000, 1),
+    ])
+
+table_header = ["mode", "stream", "topic size (B)", "#pubsub", "msgs/s", "KB/s", "lost", "p50 (us)", "p99 (us)", "p999 (us)"]
+print(tabulate(table, headers=table_header))
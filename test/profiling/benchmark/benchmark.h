@@ -0,0 +1,189 @@
+// Copyright 2017-present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PROFILING_BENCHMARK_H
+#define PROFILING_BENCHMARK_H
+
+#include <uxr/client/client.h>
+#include <uxr/client/util/time.h>
+#include <ucdr/microcdr.h>
+
+#include <stdio.h> //printf
+#include <stdlib.h> //malloc, qsort
+#include <string.h> //strcmp, memset
+
+/*
+ * Benchmark sample layout: 8 bytes timestamp (ns) + 4 bytes index + padding up to the topic size.
+ * Fields are written as raw little-endian bytes so the payload size is exactly the topic size,
+ * whatever the alignment of the serialization buffer.
+ */
+#define BENCHMARK_HEADER_SIZE   12u
+#define BENCHMARK_MAX_TOPIC     (UXR_CONFIG_UDP_TRANSPORT_MTU - 32u)
+
+typedef struct BenchmarkSample
+{
+    int64_t timestamp;
+    uint32_t index;
+
+} BenchmarkSample;
+
+typedef struct LatencyStats
+{
+    int64_t* values;
+    uint32_t size;
+    uint32_t capacity;
+
+} LatencyStats;
+
+static inline bool parse_stream_kind(const char* arg, bool* reliable)
+{
+    if (0 == strcmp(arg, "best_effort"))
+    {
+        *reliable = false;
+        return true;
+    }
+    if (0 == strcmp(arg, "reliable"))
+    {
+        *reliable = true;
+        return true;
+    }
+    return false;
+}
+
+static inline bool parse_ping_mode(const char* arg, bool* ping)
+{
+    if (0 == strcmp(arg, "throughput"))
+    {
+        *ping = false;
+        return true;
+    }
+    if (0 == strcmp(arg, "ping"))
+    {
+        *ping = true;
+        return true;
+    }
+    return false;
+}
+
+static inline bool serialize_benchmark_sample(ucdrBuffer* ub, const BenchmarkSample* sample, uint32_t topic_size)
+{
+    static const uint8_t padding[UXR_CONFIG_UDP_TRANSPORT_MTU] = {0};
+    uint8_t header[BENCHMARK_HEADER_SIZE];
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        header[i] = (uint8_t)((uint64_t)sample->timestamp >> (8 * i));
+    }
+    for (size_t i = 0; i < 4; ++i)
+    {
+        header[8 + i] = (uint8_t)(sample->index >> (8 * i));
+    }
+
+    ucdr_serialize_array_uint8_t(ub, header, BENCHMARK_HEADER_SIZE);
+    ucdr_serialize_array_uint8_t(ub, padding, topic_size - BENCHMARK_HEADER_SIZE);
+
+    return !ub->error;
+}
+
+static inline bool deserialize_benchmark_sample(ucdrBuffer* ub, BenchmarkSample* sample)
+{
+    uint8_t header[BENCHMARK_HEADER_SIZE];
+    if (!ucdr_deserialize_array_uint8_t(ub, header, BENCHMARK_HEADER_SIZE))
+    {
+        return false;
+    }
+
+    uint64_t timestamp = 0;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        timestamp |= (uint64_t)header[i] << (8 * i);
+    }
+    sample->timestamp = (int64_t)timestamp;
+
+    sample->index = 0;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        sample->index |= (uint32_t)header[8 + i] << (8 * i);
+    }
+
+    return true;
+}
+
+static inline bool latency_stats_init(LatencyStats* stats, uint32_t capacity)
+{
+    stats->values = (int64_t*)malloc(sizeof(int64_t) * (capacity ? capacity : 1));
+    stats->size = 0;
+    stats->capacity = capacity;
+    return NULL != stats->values;
+}
+
+static inline void latency_stats_fini(LatencyStats* stats)
+{
+    free(stats->values);
+    stats->values = NULL;
+    stats->size = 0;
+    stats->capacity = 0;
+}
+
+static inline void latency_stats_push(LatencyStats* stats, int64_t value)
+{
+    if (stats->size < stats->capacity)
+    {
+        stats->values[stats->size++] = value;
+    }
+}
+
+static inline int compare_int64(const void* a, const void* b)
+{
+    int64_t lhs = *(const int64_t*)a;
+    int64_t rhs = *(const int64_t*)b;
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+/* Nearest-rank percentile, values must be sorted. */
+static inline int64_t latency_stats_percentile(const LatencyStats* stats, double percentile)
+{
+    if (0 == stats->size)
+    {
+        return 0;
+    }
+
+    size_t rank = (size_t)(percentile / 100.0 * (double)stats->size + 0.5);
+    rank = (0 == rank) ? 1 : rank;
+    rank = (stats->size < rank) ? stats->size : rank;
+    return stats->values[rank - 1];
+}
+
+static inline void latency_stats_print_json(const char* name, LatencyStats* stats)
+{
+    double mean = 0.0;
+    for (uint32_t i = 0; i < stats->size; ++i)
+    {
+        mean += (double)stats->values[i];
+    }
+    mean = (0 < stats->size) ? mean / (double)stats->size : 0.0;
+    qsort(stats->values, stats->size, sizeof(int64_t), compare_int64);
+
+    printf("\"%s\": {\"count\": %u, \"mean\": %.0f, \"min\": %lld, \"p50\": %lld, \"p99\": %lld, \"p999\": %lld, \"max\": %lld}",
+        name,
+        stats->size,
+        mean,
+        (long long)latency_stats_percentile(stats, 0.0),
+        (long long)latency_stats_percentile(stats, 50.0),
+        (long long)latency_stats_percentile(stats, 99.0),
+        (long long)latency_stats_percentile(stats, 99.9),
+        (long long)latency_stats_percentile(stats, 100.0));
+}
+
+#endif // PROFILING_BENCHMARK_H
@@ -0,0 +1,235 @@
+// Copyright 2017-present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+
+#define STREAM_HISTORY  8
+#define BUFFER_SIZE     UXR_CONFIG_UDP_TRANSPORT_MTU * STREAM_HISTORY
+#define ECHO_TIMEOUT    1000
+
+typedef struct EchoState
+{
+    uint32_t expected_index;
+    bool received;
+    LatencyStats rtt;
+
+} EchoState;
+
+void on_echo(
+        uxrSession* session,
+        uxrObjectId object_id,
+        uint16_t request_id,
+        uxrStreamId stream_id,
+        struct ucdrBuffer* ub,
+        uint16_t length,
+        void* args)
+{
+    (void) session; (void) object_id; (void) request_id; (void) stream_id; (void) length;
+
+    EchoState* state = (EchoState*) args;
+    BenchmarkSample sample;
+    if(deserialize_benchmark_sample(ub, &sample) && sample.index == state->expected_index)
+    {
+        latency_stats_push(&state->rtt, uxr_nanos() - sample.timestamp);
+        state->received = true;
+    }
+}
+
+int main(int args, char** argv)
+{
+    // CLI
+    if(7 > args)
+    {
+        printf("usage: client_key  topic_name  topic_size  samples  <best_effort|reliable>  <throughput|ping>\n");
+        return 0;
+    }
+
+    bool reliable;
+    bool ping;
+    if(!parse_stream_kind(argv[5], &reliable) || !parse_ping_mode(argv[6], &ping))
+    {
+        printf("Error at parse arguments.\n");
+        return 1;
+    }
+
+    uint32_t client_key = (uint32_t)atoi(argv[1]);
+    char* topic_name = argv[2];
+    uint32_t topic_size = (uint32_t)atoi(argv[3]);
+    topic_size = (BENCHMARK_HEADER_SIZE > topic_size) ? BENCHMARK_HEADER_SIZE : topic_size;
+    topic_size = (BENCHMARK_MAX_TOPIC < topic_size) ? BENCHMARK_MAX_TOPIC : topic_size;
+    uint32_t samples = (uint32_t)atoi(argv[4]);
+
+    char echo_name[128];
+    snprintf(echo_name, sizeof(echo_name), "%s_echo", topic_name);
+
+    EchoState echo_state = {0};
+    if(!latency_stats_init(&echo_state.rtt, ping ? samples : 0))
+    {
+        printf("Error at allocate statistics.\n");
+        return 1;
+    }
+
+    // Transport
+    uxrUDPTransport transport;
+    if(!uxr_init_udp_transport(&transport, UXR_IPv4, "127.0.0.1", "2020"))
+    {
+        printf("Error at create transport.\n");
+        return 1;
+    }
+
+    // Session
+    uxrSession session;
+    uxr_init_session(&session, &transport.comm, client_key);
+    uxr_set_topic_callback(&session, on_echo, &echo_state);
+    if(!uxr_create_session(&session))
+    {
+        printf("Error at create session.\n");
+        return 1;
+    }
+
+    // Streams
+    uint8_t output_besteffort_stream_buffer[UXR_CONFIG_UDP_TRANSPORT_MTU];
+    uxrStreamId besteffort_out = uxr_create_output_best_effort_stream(&session, output_besteffort_stream_buffer, UXR_CONFIG_UDP_TRANSPORT_MTU);
+
+    uint8_t output_reliable_stream_buffer[BUFFER_SIZE];
+    uxrStreamId reliable_out = uxr_create_output_reliable_stream(&session, output_reliable_stream_buffer, BUFFER_SIZE, STREAM_HISTORY);
+
+    uxrStreamId besteffort_in = uxr_create_input_best_effort_stream(&session);
+
+    uint8_t input_reliable_stream_buffer[BUFFER_SIZE];
+    uxrStreamId reliable_in = uxr_create_input_reliable_stream(&session, input_reliable_stream_buffer, BUFFER_SIZE, STREAM_HISTORY);
+
+    uxrStreamId data_out = reliable ? reliable_out : besteffort_out;
+    uxrStreamId data_in = reliable ? reliable_in : besteffort_in;
+
+    // Create entities
+    uxrObjectId participant_id = uxr_object_id(0x01, UXR_PARTICIPANT_ID);
+    const char* participant_ref = "participant_name";
+    uint16_t participant_req = uxr_buffer_create_participant_ref(&session, reliable_out, participant_id, 0, participant_ref, UXR_REPLACE);
+
+    uxrObjectId topic_id = uxr_object_id(0x01, UXR_TOPIC_ID);
+    const char* topic_ref = topic_name;
+    uint16_t topic_req = uxr_buffer_create_topic_ref(&session, reliable_out, topic_id, participant_id, topic_ref, UXR_REPLACE);
+
+    uxrObjectId publisher_id = uxr_object_id(0x01, UXR_PUBLISHER_ID);
+    const char* publisher_xml = "";
+    uint16_t publisher_req = uxr_buffer_create_publisher_xml(&session, reliable_out, publisher_id, participant_id, publisher_xml, UXR_REPLACE);
+
+    uxrObjectId datawriter_id = uxr_object_id(0x01, UXR_DATAWRITER_ID);
+    const char* datawriter_ref = topic_ref;
+    uint16_t datawriter_req = uxr_buffer_create_datawriter_xml(&session, reliable_out, datawriter_id, publisher_id, datawriter_ref, UXR_REPLACE);
+
+    // Send create entities message and wait its status
+    uint8_t status[4];
+    uint16_t requests[4] = {participant_req, topic_req, publisher_req, datawriter_req};
+    if(!uxr_run_session_until_all_status(&session, 1000, requests, status, 4))
+    {
+        printf("Error at create entities: participant: %i topic: %i publisher: %i darawriter: %i\n", status[0], status[1], status[2], status[3]);
+        return 1;
+    }
+
+    // Echo entities, only for round-trip measurements
+    if(ping)
+    {
+        uxrObjectId echo_topic_id = uxr_object_id(0x02, UXR_TOPIC_ID);
+        uint16_t echo_topic_req = uxr_buffer_create_topic_ref(&session, reliable_out, echo_topic_id, participant_id, echo_name, UXR_REPLACE);
+
+        uxrObjectId subscriber_id = uxr_object_id(0x02, UXR_SUBSCRIBER_ID);
+        const char* subscriber_xml = "";
+        uint16_t subscriber_req = uxr_buffer_create_subscriber_xml(&session, reliable_out, subscriber_id, participant_id, subscriber_xml, UXR_REPLACE);
+
+        uxrObjectId datareader_id = uxr_object_id(0x02, UXR_DATAREADER_ID);
+        uint16_t datareader_req = uxr_buffer_create_datareader_ref(&session, reliable_out, datareader_id, subscriber_id, echo_name, UXR_REPLACE);
+
+        uint16_t echo_requests[3] = {echo_topic_req, subscriber_req, datareader_req};
+        if(!uxr_run_session_until_all_status(&session, 1000, echo_requests, status, 3))
+        {
+            printf("Error at create echo entities: topic: %i subscriber: %i datareader: %i\n", status[0], status[1], status[2]);
+            return 1;
+        }
+
+        uxrDeliveryControl delivery_control = {0};
+        delivery_control.max_samples = UXR_MAX_SAMPLES_UNLIMITED;
+        uxr_buffer_request_data(&session, reliable_out, datareader_id, data_in, &delivery_control);
+        uxr_run_session_time(&session, 100);
+    }
+
+    // Write topics
+    bool connected = true;
+    uint32_t sent = 0;
+    uint32_t lost_echoes = 0;
+    int64_t start = uxr_nanos();
+    while(connected && sent < samples)
+    {
+        ucdrBuffer ub;
+        while(0 == uxr_prepare_output_stream(&session, data_out, datawriter_id, &ub, topic_size))
+        {
+            // Reliable history is full, wait for the agent acknack.
+            connected = uxr_run_session_time(&session, 1);
+            if(!connected)
+            {
+                break;
+            }
+        }
+        if(!connected)
+        {
+            break;
+        }
+
+        BenchmarkSample sample = {uxr_nanos(), sent};
+        serialize_benchmark_sample(&ub, &sample, topic_size);
+        uxr_flash_output_streams(&session);
+        ++sent;
+
+        if(ping)
+        {
+            echo_state.expected_index = sample.index;
+            echo_state.received = false;
+            int64_t deadline = uxr_millis() + ECHO_TIMEOUT;
+            while(!echo_state.received && uxr_millis() < deadline)
+            {
+                uxr_run_session_timeout(&session, 1);
+            }
+            lost_echoes += echo_state.received ? 0 : 1;
+        }
+        else
+        {
+            // Process incoming acknacks and heartbeats without blocking.
+            uxr_run_session_timeout(&session, 0);
+        }
+    }
+
+    if(reliable)
+    {
+        uxr_run_session_until_confirm_delivery(&session, 1000);
+    }
+    int64_t elapsed = uxr_nanos() - start;
+
+    // Report
+    double seconds = (0 < elapsed) ? (double)elapsed / 1e9 : 1e-9;
+    printf("{\"role\": \"publisher\", \"client_key\": %u, \"topic\": \"%s\", \"topic_size\": %u, \"stream\": \"%s\", \"mode\": \"%s\", "
+           "\"sent\": %u, \"elapsed_ns\": %lld, \"msgs_per_sec\": %.1f, \"bytes_per_sec\": %.1f, \"lost_echoes\": %u, ",
+        client_key, topic_name, topic_size, argv[5], argv[6],
+        sent, (long long)elapsed, (double)sent / seconds, (double)sent * topic_size / seconds, lost_echoes);
+    latency_stats_print_json("rtt_ns", &echo_state.rtt);
+    printf("}\n");
+    fflush(stdout);
+
+    // Delete resources
+    latency_stats_fini(&echo_state.rtt);
+    uxr_delete_session(&session);
+    uxr_close_udp_transport(&transport);
+
+    return 0;
+}
@@ -0,0 +1,369 @@
+// Copyright 2017-present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#define _DEFAULT_SOURCE
+
+#include "benchmark.h"
+
+#include <dirent.h> //opendir
+#include <sys/resource.h> //setrlimit
+#include <unistd.h> //sysconf
+
+#define STREAM_HISTORY  2
+#define BUFFER_SIZE     UXR_CONFIG_UDP_TRANSPORT_MTU * STREAM_HISTORY
+#define ROUND_TIMEOUT   1000
+#define BASE_CLIENT_KEY 0xBE000000
+
+/*
+ * Every simulated session is a full XRCE client: its own transport, client_key and
+ * a datawriter/datareader pair on its own topic, so each sample goes through the agent.
+ */
+typedef struct BenchmarkSession
+{
+    union
+    {
+        uxrUDPTransport udp;
+        uxrTCPTransport tcp;
+    } transport;
+    uxrSession session;
+    uint8_t output_besteffort_stream_buffer[UXR_CONFIG_UDP_TRANSPORT_MTU];
+    uint8_t output_reliable_stream_buffer[BUFFER_SIZE];
+    uint8_t input_reliable_stream_buffer[BUFFER_SIZE];
+    uxrStreamId besteffort_out;
+    uxrObjectId datawriter_id;
+    uint32_t received;
+    bool transport_ready;
+    bool ready;
+
+} BenchmarkSession;
+
+typedef struct ProcessUsage
+{
+    uint64_t cpu_ns;
+    uint64_t voluntary_switches;
+    uint64_t involuntary_switches;
+
+} ProcessUsage;
+
+static LatencyStats latency;
+static bool use_tcp;
+
+void on_topic(
+        uxrSession* session,
+        uxrObjectId object_id,
+        uint16_t request_id,
+        uxrStreamId stream_id,
+        struct ucdrBuffer* ub,
+        uint16_t length,
+        void* args)
+{
+    (void) session; (void) object_id; (void) request_id; (void) stream_id; (void) length;
+
+    int64_t now = uxr_nanos();
+    BenchmarkSession* bench = (BenchmarkSession*) args;
+    BenchmarkSample sample;
+    if(deserialize_benchmark_sample(ub, &sample))
+    {
+        latency_stats_push(&latency, now - sample.timestamp);
+        ++bench->received;
+    }
+}
+
+static uint64_t read_task_cpu_ns(long pid, const char* tid)
+{
+    // The first field of schedstat is the time spent on the CPU, in nanoseconds.
+    char path[128];
+    snprintf(path, sizeof(path), "/proc/%ld/task/%s/schedstat", pid, tid);
+    FILE* file = fopen(path, "r");
+    if(NULL != file)
+    {
+        unsigned long long cpu_ns = 0;
+        int fields = fscanf(file, "%llu", &cpu_ns);
+        fclose(file);
+        if(1 == fields)
+        {
+            return cpu_ns;
+        }
+    }
+
+    // Kernels without schedstat: utime and stime of the stat file, in clock ticks.
+    // The command name may contain spaces, so fields are counted from its closing parenthesis.
+    snprintf(path, sizeof(path), "/proc/%ld/task/%s/stat", pid, tid);
+    file = fopen(path, "r");
+    if(NULL == file)
+    {
+        return 0;
+    }
+    char stat[1024];
+    size_t length = fread(stat, 1, sizeof(stat) - 1, file);
+    fclose(file);
+    stat[length] = '\0';
+
+    char* end = strrchr(stat, ')');
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    if(NULL == end || 2 != sscanf(end + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu", &utime, &stime))
+    {
+        return 0;
+    }
+    return (utime + stime) * (1000000000ULL / (unsigned long long)sysconf(_SC_CLK_TCK));
+}
+
+static bool read_process_usage(long pid, ProcessUsage* usage)
+{
+    memset(usage, 0, sizeof(ProcessUsage));
+
+    // CPU time and context switches are summed over the threads of the process.
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%ld/task", pid);
+    DIR* tasks = opendir(path);
+    if(NULL == tasks)
+    {
+        return false;
+    }
+
+    struct dirent* task;
+    while(NULL != (task = readdir(tasks)))
+    {
+        if('.' == task->d_name[0])
+        {
+            continue;
+        }
+
+        usage->cpu_ns += read_task_cpu_ns(pid, task->d_name);
+
+        char status_path[128];
+        snprintf(status_path, sizeof(status_path), "/proc/%ld/task/%s/status", pid, task->d_name);
+        FILE* status = fopen(status_path, "r");
+        if(NULL == status)
+        {
+            continue;
+        }
+
+        char line[256];
+        unsigned long long value;
+        while(NULL != fgets(line, sizeof(line), status))
+        {
+            if(1 == sscanf(line, "voluntary_ctxt_switches: %llu", &value))
+            {
+                usage->voluntary_switches += value;
+            }
+            else if(1 == sscanf(line, "nonvoluntary_ctxt_switches: %llu", &value))
+            {
+                usage->involuntary_switches += value;
+            }
+        }
+        fclose(status);
+    }
+    closedir(tasks);
+
+    return true;
+}
+
+static void raise_file_limit(void)
+{
+    struct rlimit limit;
+    if(0 == getrlimit(RLIMIT_NOFILE, &limit))
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static bool init_benchmark_session(BenchmarkSession* bench, uint32_t index, const char* port)
+{
+    bench->transport_ready = use_tcp
+        ? uxr_init_tcp_transport(&bench->transport.tcp, UXR_IPv4, "127.0.0.1", port)
+        : uxr_init_udp_transport(&bench->transport.udp, UXR_IPv4, "127.0.0.1", port);
+    if(!bench->transport_ready)
+    {
+        return false;
+    }
+
+    uxrSession* session = &bench->session;
+    uxr_init_session(session, use_tcp ? &bench->transport.tcp.comm : &bench->transport.udp.comm, BASE_CLIENT_KEY + index);
+    uxr_set_topic_callback(session, on_topic, bench);
+    if(!uxr_create_session(session))
+    {
+        return false;
+    }
+
+    bench->besteffort_out = uxr_create_output_best_effort_stream(session, bench->output_besteffort_stream_buffer, UXR_CONFIG_UDP_TRANSPORT_MTU);
+    uxrStreamId reliable_out = uxr_create_output_reliable_stream(session, bench->output_reliable_stream_buffer, BUFFER_SIZE, STREAM_HISTORY);
+    uxrStreamId besteffort_in = uxr_create_input_best_effort_stream(session);
+    uxr_create_input_reliable_stream(session, bench->input_reliable_stream_buffer, BUFFER_SIZE, STREAM_HISTORY);
+
+    char topic_name[32];
+    snprintf(topic_name, sizeof(topic_name), "topic_name_%u", index);
+
+    uxrObjectId participant_id = uxr_object_id(0x01, UXR_PARTICIPANT_ID);
+    uint16_t participant_req = uxr_buffer_create_participant_ref(session, reliable_out, participant_id, 0, "participant_name", UXR_REPLACE);
+
+    uxrObjectId topic_id = uxr_object_id(0x01, UXR_TOPIC_ID);
+    uint16_t topic_req = uxr_buffer_create_topic_ref(session, reliable_out, topic_id, participant_id, topic_name, UXR_REPLACE);
+
+    uxrObjectId publisher_id = uxr_object_id(0x01, UXR_PUBLISHER_ID);
+    uint16_t publisher_req = uxr_buffer_create_publisher_xml(session, reliable_out, publisher_id, participant_id, "", UXR_REPLACE);
+
+    bench->datawriter_id = uxr_object_id(0x01, UXR_DATAWRITER_ID);
+    uint16_t datawriter_req = uxr_buffer_create_datawriter_xml(session, reliable_out, bench->datawriter_id, publisher_id, topic_name, UXR_REPLACE);
+
+    uxrObjectId subscriber_id = uxr_object_id(0x01, UXR_SUBSCRIBER_ID);
+    uint16_t subscriber_req = uxr_buffer_create_subscriber_xml(session, reliable_out, subscriber_id, participant_id, "", UXR_REPLACE);
+
+    uxrObjectId datareader_id = uxr_object_id(0x01, UXR_DATAREADER_ID);
+    uint16_t datareader_req = uxr_buffer_create_datareader_ref(session, reliable_out, datareader_id, subscriber_id, topic_name, UXR_REPLACE);
+
+    uint8_t status[6];
+    uint16_t requests[6] = {participant_req, topic_req, publisher_req, datawriter_req, subscriber_req, datareader_req};
+    if(!uxr_run_session_until_all_status(session, 1000, requests, status, 6))
+    {
+        return false;
+    }
+
+    uxrDeliveryControl delivery_control = {0};
+    delivery_control.max_samples = UXR_MAX_SAMPLES_UNLIMITED;
+    uxr_buffer_request_data(session, reliable_out, datareader_id, besteffort_in, &delivery_control);
+    bench->ready = uxr_run_session_until_confirm_delivery(session, 1000);
+
+    return bench->ready;
+}
+
+static void fini_benchmark_session(BenchmarkSession* bench)
+{
+    if(bench->ready)
+    {
+        uxr_delete_session(&bench->session);
+    }
+    if(bench->transport_ready)
+    {
+        if(use_tcp)
+        {
+            uxr_close_tcp_transport(&bench->transport.tcp);
+        }
+        else
+        {
+            uxr_close_udp_transport(&bench->transport.udp);
+        }
+    }
+}
+
+int main(int args, char** argv)
+{
+    // CLI
+    if(7 > args)
+    {
+        printf("usage: <udp|tcp>  port  sessions  rounds  topic_size  agent_pid\n");
+        return 0;
+    }
+
+    use_tcp = (0 == strcmp(argv[1], "tcp"));
+    const char* port = argv[2];
+    uint32_t sessions = (uint32_t)atoi(argv[3]);
+    uint32_t rounds = (uint32_t)atoi(argv[4]);
+    uint32_t topic_size = (uint32_t)atoi(argv[5]);
+    topic_size = (BENCHMARK_HEADER_SIZE > topic_size) ? BENCHMARK_HEADER_SIZE : topic_size;
+    topic_size = (BENCHMARK_MAX_TOPIC < topic_size) ? BENCHMARK_MAX_TOPIC : topic_size;
+    long agent_pid = atol(argv[6]);
+
+    raise_file_limit();
+
+    BenchmarkSession* benches = (BenchmarkSession*)calloc(sessions, sizeof(BenchmarkSession));
+    if(NULL == benches || !latency_stats_init(&latency, sessions * rounds))
+    {
+        printf("Error at allocate sessions.\n");
+        return 1;
+    }
+
+    // Sessions
+    uint32_t ready = 0;
+    int64_t setup_start = uxr_millis();
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        if(!init_benchmark_session(&benches[i], i, port))
+        {
+            printf("Error at create session %u.\n", i);
+            break;
+        }
+        ++ready;
+    }
+    int64_t setup_elapsed = uxr_millis() - setup_start;
+
+    // Write topics, one sample per session and round
+    ProcessUsage usage_start;
+    ProcessUsage usage_end;
+    bool usage_available = read_process_usage(agent_pid, &usage_start);
+
+    uint32_t sent = 0;
+    uint32_t received = 0;
+    int64_t start = uxr_nanos();
+    for(uint32_t round = 0; round < rounds; ++round)
+    {
+        for(uint32_t i = 0; i < ready; ++i)
+        {
+            ucdrBuffer ub;
+            BenchmarkSession* bench = &benches[i];
+            if(0 != uxr_prepare_output_stream(&bench->session, bench->besteffort_out, bench->datawriter_id, &ub, topic_size))
+            {
+                BenchmarkSample sample = {uxr_nanos(), round};
+                serialize_benchmark_sample(&ub, &sample, topic_size);
+                uxr_flash_output_streams(&bench->session);
+                ++sent;
+            }
+        }
+
+        int64_t deadline = uxr_millis() + ROUND_TIMEOUT;
+        do
+        {
+            received = 0;
+            for(uint32_t i = 0; i < ready; ++i)
+            {
+                uxr_run_session_timeout(&benches[i].session, 0);
+                received += benches[i].received;
+            }
+        }
+        while(received < sent && uxr_millis() < deadline);
+    }
+    int64_t elapsed = uxr_nanos() - start;
+
+    usage_available = usage_available && read_process_usage(agent_pid, &usage_end);
+
+    // Report
+    double seconds = (0 < elapsed) ? (double)elapsed / 1e9 : 1e-9;
+    double agent_cpu_ns = usage_available
+        ? (double)(usage_end.cpu_ns - usage_start.cpu_ns)
+        : 0.0;
+    printf("{\"transport\": \"%s\", \"sessions\": %u, \"ready\": %u, \"rounds\": %u, \"topic_size\": %u, "
+           "\"setup_ms\": %lld, \"sent\": %u, \"received\": %u, \"elapsed_ns\": %lld, \"msgs_per_sec\": %.1f, "
+           "\"agent_cpu_ns\": %.0f, \"agent_cpu_ns_per_sample\": %.1f, "
+           "\"voluntary_ctxt_switches\": %llu, \"nonvoluntary_ctxt_switches\": %llu, ",
+        argv[1], sessions, ready, rounds, topic_size,
+        (long long)setup_elapsed, sent, received, (long long)elapsed, (double)received / seconds,
+        agent_cpu_ns, (0 < received) ? agent_cpu_ns / (double)received : 0.0,
+        usage_available ? (unsigned long long)(usage_end.voluntary_switches - usage_start.voluntary_switches) : 0ull,
+        usage_available ? (unsigned long long)(usage_end.involuntary_switches - usage_start.involuntary_switches) : 0ull);
+    latency_stats_print_json("latency_ns", &latency);
+    printf("}\n");
+    fflush(stdout);
+
+    // Delete resources
+    for(uint32_t i = 0; i < sessions; ++i)
+    {
+        fini_benchmark_session(&benches[i]);
+    }
+    latency_stats_fini(&latency);
+    free(benches);
+
+    return 0;
+}
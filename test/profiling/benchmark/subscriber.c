@@ -0,0 +1,226 @@
+// Copyright 2017-present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark.h"
+
+#define STREAM_HISTORY  8
+#define BUFFER_SIZE     UXR_CONFIG_UDP_TRANSPORT_MTU * STREAM_HISTORY
+#define FIRST_TIMEOUT   10000
+#define IDLE_TIMEOUT    2000
+
+typedef struct ReaderState
+{
+    uint32_t received;
+    uint32_t bytes;
+    int64_t first_timestamp;
+    int64_t last_timestamp;
+    LatencyStats latency;
+    bool echo_pending;
+    BenchmarkSample echo_sample;
+    uint16_t echo_size;
+
+} ReaderState;
+
+void on_topic(
+        uxrSession* session,
+        uxrObjectId object_id,
+        uint16_t request_id,
+        uxrStreamId stream_id,
+        struct ucdrBuffer* ub,
+        uint16_t length,
+        void* args)
+{
+    (void) session; (void) object_id; (void) request_id; (void) stream_id;
+
+    int64_t now = uxr_nanos();
+    ReaderState* state = (ReaderState*) args;
+    BenchmarkSample sample;
+    if(!deserialize_benchmark_sample(ub, &sample))
+    {
+        return;
+    }
+
+    latency_stats_push(&state->latency, now - sample.timestamp);
+    state->first_timestamp = (0 == state->received) ? now : state->first_timestamp;
+    state->last_timestamp = now;
+    state->bytes += length;
+    ++state->received;
+
+    state->echo_sample = sample;
+    state->echo_size = length;
+    state->echo_pending = true;
+}
+
+int main(int args, char** argv)
+{
+    // CLI
+    if(6 > args)
+    {
+        printf("usage: client_key  topic_name  samples  <best_effort|reliable>  <throughput|ping>\n");
+        return 0;
+    }
+
+    bool reliable;
+    bool ping;
+    if(!parse_stream_kind(argv[4], &reliable) || !parse_ping_mode(argv[5], &ping))
+    {
+        printf("Error at parse arguments.\n");
+        return 1;
+    }
+
+    uint32_t client_key = (uint32_t)atoi(argv[1]);
+    char* topic_name = argv[2];
+    uint32_t samples = (uint32_t)atoi(argv[3]);
+
+    char echo_name[128];
+    snprintf(echo_name, sizeof(echo_name), "%s_echo", topic_name);
+
+    ReaderState state = {0};
+    if(!latency_stats_init(&state.latency, samples))
+    {
+        printf("Error at allocate statistics.\n");
+        return 1;
+    }
+
+    // Transport
+    uxrUDPTransport transport;
+    if(!uxr_init_udp_transport(&transport, UXR_IPv4, "127.0.0.1", "2020"))
+    {
+        printf("Error at create transport.\n");
+        return 1;
+    }
+
+    // Session
+    uxrSession session;
+    uxr_init_session(&session, &transport.comm, client_key);
+    uxr_set_topic_callback(&session, on_topic, &state);
+    if(!uxr_create_session(&session))
+    {
+        printf("Error at create session.\n");
+        return 1;
+    }
+
+    // Streams
+    uint8_t output_besteffort_stream_buffer[UXR_CONFIG_UDP_TRANSPORT_MTU];
+    uxrStreamId besteffort_out = uxr_create_output_best_effort_stream(&session, output_besteffort_stream_buffer, UXR_CONFIG_UDP_TRANSPORT_MTU);
+
+    uint8_t output_reliable_stream_buffer[BUFFER_SIZE];
+    uxrStreamId reliable_out = uxr_create_output_reliable_stream(&session, output_reliable_stream_buffer, BUFFER_SIZE, STREAM_HISTORY);
+
+    uxrStreamId besteffort_in = uxr_create_input_best_effort_stream(&session);
+
+    uint8_t input_reliable_stream_buffer[BUFFER_SIZE];
+    uxrStreamId reliable_in = uxr_create_input_reliable_stream(&session, input_reliable_stream_buffer, BUFFER_SIZE, STREAM_HISTORY);
+
+    uxrStreamId data_out = reliable ? reliable_out : besteffort_out;
+    uxrStreamId data_in = reliable ? reliable_in : besteffort_in;
+
+    // Create entities
+    uxrObjectId participant_id = uxr_object_id(0x01, UXR_PARTICIPANT_ID);
+    const char* participant_ref = "participant_name";
+    uint16_t participant_req = uxr_buffer_create_participant_ref(&session, reliable_out, participant_id, 0, participant_ref, UXR_REPLACE);
+
+    uxrObjectId topic_id = uxr_object_id(0x01, UXR_TOPIC_ID);
+    const char* topic_ref = topic_name;
+    uint16_t topic_req = uxr_buffer_create_topic_ref(&session, reliable_out, topic_id, participant_id, topic_ref, UXR_REPLACE);
+
+    uxrObjectId subscriber_id = uxr_object_id(0x01, UXR_SUBSCRIBER_ID);
+    const char* subscriber_xml = "";
+    uint16_t subscriber_req = uxr_buffer_create_subscriber_xml(&session, reliable_out, subscriber_id, participant_id, subscriber_xml, UXR_REPLACE);
+
+    uxrObjectId datareader_id = uxr_object_id(0x01, UXR_DATAREADER_ID);
+    const char* datareader_ref = topic_ref;
+    uint16_t datareader_req = uxr_buffer_create_datareader_ref(&session, reliable_out, datareader_id, subscriber_id, datareader_ref, UXR_REPLACE);
+
+    // Send create entities message and wait its status
+    uint8_t status[4];
+    uint16_t requests[4] = {participant_req, topic_req, subscriber_req, datareader_req};
+    if(!uxr_run_session_until_all_status(&session, 1000, requests, status, 4))
+    {
+        printf("Error at create entities: participant: %i topic: %i subscriber: %i datareader: %i\n", status[0], status[1], status[2], status[3]);
+        return 1;
+    }
+
+    // Echo entities, only for round-trip measurements
+    uxrObjectId echo_datawriter_id = uxr_object_id(0x02, UXR_DATAWRITER_ID);
+    if(ping)
+    {
+        uxrObjectId echo_topic_id = uxr_object_id(0x02, UXR_TOPIC_ID);
+        uint16_t echo_topic_req = uxr_buffer_create_topic_ref(&session, reliable_out, echo_topic_id, participant_id, echo_name, UXR_REPLACE);
+
+        uxrObjectId publisher_id = uxr_object_id(0x02, UXR_PUBLISHER_ID);
+        const char* publisher_xml = "";
+        uint16_t publisher_req = uxr_buffer_create_publisher_xml(&session, reliable_out, publisher_id, participant_id, publisher_xml, UXR_REPLACE);
+
+        uint16_t datawriter_req = uxr_buffer_create_datawriter_xml(&session, reliable_out, echo_datawriter_id, publisher_id, echo_name, UXR_REPLACE);
+
+        uint16_t echo_requests[3] = {echo_topic_req, publisher_req, datawriter_req};
+        if(!uxr_run_session_until_all_status(&session, 1000, echo_requests, status, 3))
+        {
+            printf("Error at create echo entities: topic: %i publisher: %i datawriter: %i\n", status[0], status[1], status[2]);
+            return 1;
+        }
+    }
+
+    // Request topics
+    uxrDeliveryControl delivery_control = {0};
+    delivery_control.max_samples = UXR_MAX_SAMPLES_UNLIMITED;
+    uxr_buffer_request_data(&session, reliable_out, datareader_id, data_in, &delivery_control);
+
+    // Read topics
+    int64_t start = uxr_millis();
+    while(state.received < samples)
+    {
+        uxr_run_session_timeout(&session, 1);
+
+        if(ping && state.echo_pending)
+        {
+            ucdrBuffer ub;
+            if(0 != uxr_prepare_output_stream(&session, data_out, echo_datawriter_id, &ub, state.echo_size))
+            {
+                serialize_benchmark_sample(&ub, &state.echo_sample, state.echo_size);
+                uxr_flash_output_streams(&session);
+                state.echo_pending = false;
+            }
+        }
+
+        int64_t now = uxr_millis();
+        if((0 == state.received && FIRST_TIMEOUT < now - start)
+            || (0 != state.received && IDLE_TIMEOUT < now - state.last_timestamp / 1000000))
+        {
+            break;
+        }
+    }
+
+    // Report
+    int64_t elapsed = state.last_timestamp - state.first_timestamp;
+    double seconds = (0 < elapsed) ? (double)elapsed / 1e9 : 1e-9;
+    uint32_t received = state.received;
+    printf("{\"role\": \"subscriber\", \"client_key\": %u, \"topic\": \"%s\", \"stream\": \"%s\", \"mode\": \"%s\", "
+           "\"received\": %u, \"lost\": %u, \"elapsed_ns\": %lld, \"msgs_per_sec\": %.1f, \"bytes_per_sec\": %.1f, ",
+        client_key, topic_name, argv[4], argv[5],
+        received, (samples > received) ? samples - received : 0, (long long)elapsed,
+        (1 < received) ? (double)(received - 1) / seconds : 0.0,
+        (1 < received) ? (double)state.bytes * (received - 1) / received / seconds : 0.0);
+    latency_stats_print_json("latency_ns", &state.latency);
+    printf("}\n");
+    fflush(stdout);
+
+    // Delete resources
+    latency_stats_fini(&state.latency);
+    uxr_delete_session(&session);
+    uxr_close_udp_transport(&transport);
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+import json
+import signal
+import subprocess
+import sys
+import time
+from tabulate import tabulate
+
+n_pubsub = [1, 1 << 1, 1 << 2, 1 << 3, 1 << 4, 1 << 5]
+topic_size = [1 << 8, 1 << 3]
+n_clients = [1, 10, 100]
+subsystems = ["other", "sessions", "streams", "entities", "data"]
+
+def last_json(text):
+    for line in reversed(text.splitlines()):
+        if line.startswith("{"):
+            return json.loads(line)
+    return None
+
+# Same scenario as agent-profiling.py, measured in-process at native speed.
+total_usage = []
+for t in topic_size:
+    total = [t]
+    for n in n_pubsub:
+        agent_sp = subprocess.Popen(["./install/bin/agent-footprint"], stderr=subprocess.PIPE, universal_newlines=True)
+        time.sleep(1)
+
+        client_key = 1
+        sub_sps = []
+        pub_sps = []
+        for i in range(n):
+            sub_sps.append(subprocess.Popen(["./install/bin/subscriber-profiling {} topic_name_{}".format(client_key, i)], shell=True, stdout=subprocess.DEVNULL))
+            client_key += 1
+            pub_sps.append(subprocess.Popen(["./install/bin/publisher-profiling {} topic_name_{} {}".format(client_key, i, t)], shell=True, stdout=subprocess.DEVNULL))
+            client_key += 1
+
+        time.sleep(5)
+
+        for i in range(n):
+            pub_sps[i].terminate()
+            sub_sps[i].terminate()
+
+        agent_sp.send_signal(signal.SIGINT)
+        _, err = agent_sp.communicate()
+
+        report = last_json(err)
+        total.append(round((report["total"]["peak"] + report["stack"]["main"] + report["stack"]["max_thread"]) / 1000, 2))
+
+    total_usage.append(total)
+
+table_header = ["topic size (B) / #topics"]
+for n in n_pubsub:
+    table_header.append(n)
+print(tabulate(total_usage, headers=table_header))
+print()
+
+# Peak bytes per subsystem and client, Agent and clients in the same process.
+phase_usage = []
+for n in n_clients:
+    out = subprocess.check_output(["./install/bin/footprint-profiling", str(n), str(topic_size[0]), "10"], universal_newlines=True)
+    phases = [json.loads(line) for line in out.splitlines() if line.startswith("{")]
+    data = next(p for p in phases if p["phase"] == "data")["footprint"]
+    row = [n]
+    for s in subsystems:
+        row.append(round(data["subsystems"][s]["peak"] / n / 1000, 2))
+    row.append(round(data["stack"]["max_thread"] / 1000, 2))
+    phase_usage.append(row)
+
+table_header = ["#clients"] + ["{} (KB/client)".format(s) for s in subsystems] + ["thread stack (KB)"]
+print(tabulate(phase_usage, headers=table_header))
+
+if len(sys.argv) > 1:
+    with open(sys.argv[1], "w") as f:
+        json.dump({"agent": total_usage, "phases": phase_usage}, f, indent=2)
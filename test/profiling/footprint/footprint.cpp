@@ -0,0 +1,438 @@
+// Copyright 2017-present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "footprint.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace footprint {
+namespace {
+
+constexpr size_t subsystem_count = size_t(Subsystem::COUNT);
+constexpr size_t max_tracked_stacks = 1024;
+
+/*
+ * Every allocation is prefixed with a header that keeps its size and subsystem,
+ * so it is released from the same counters it was charged to. The header sits right
+ * before the payload, offset bytes after the start of the block.
+ */
+struct alignas(16) Header
+{
+    size_t size;
+    uint32_t offset;
+    uint8_t subsystem;
+};
+
+struct ThreadStack
+{
+    uint8_t* base;
+    size_t size;
+};
+
+std::atomic<uint8_t> current_subsystem{uint8_t(Subsystem::OTHER)};
+std::atomic<int64_t> live_bytes[subsystem_count];
+std::atomic<int64_t> peak_bytes[subsystem_count];
+std::atomic<uint64_t> allocations[subsystem_count];
+std::atomic<uint64_t> deallocations[subsystem_count];
+std::atomic<int64_t> total_live_bytes{0};
+std::atomic<int64_t> total_peak_bytes{0};
+
+ThreadStack thread_stacks[max_tracked_stacks];
+std::atomic<size_t> thread_stack_count{0};
+
+void update_peak(std::atomic<int64_t>& peak, int64_t value)
+{
+    int64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void* tracked_alloc(size_t size, size_t alignment = alignof(Header))
+{
+    // Over-aligned payloads start one alignment into the block, which leaves room for the header.
+    size_t offset = (sizeof(Header) < alignment) ? alignment : sizeof(Header);
+    void* block = nullptr;
+    if (alignof(Header) >= alignment)
+    {
+        block = std::malloc(offset + size);
+    }
+    else if (0 != posix_memalign(&block, alignment, offset + size))
+    {
+        block = nullptr;
+    }
+    if (nullptr == block)
+    {
+        return nullptr;
+    }
+
+    Header* header = reinterpret_cast<Header*>(static_cast<uint8_t*>(block) + offset) - 1;
+    uint8_t subsystem = current_subsystem.load(std::memory_order_relaxed);
+    header->size = size;
+    header->offset = uint32_t(offset);
+    header->subsystem = subsystem;
+
+    int64_t live = live_bytes[subsystem].fetch_add(int64_t(size), std::memory_order_relaxed) + int64_t(size);
+    update_peak(peak_bytes[subsystem], live);
+    allocations[subsystem].fetch_add(1, std::memory_order_relaxed);
+
+    int64_t total = total_live_bytes.fetch_add(int64_t(size), std::memory_order_relaxed) + int64_t(size);
+    update_peak(total_peak_bytes, total);
+
+    return header + 1;
+}
+
+void tracked_free(void* ptr)
+{
+    if (nullptr == ptr)
+    {
+        return;
+    }
+
+    Header* header = static_cast<Header*>(ptr) - 1;
+    live_bytes[header->subsystem].fetch_sub(int64_t(header->size), std::memory_order_relaxed);
+    deallocations[header->subsystem].fetch_add(1, std::memory_order_relaxed);
+    total_live_bytes.fetch_sub(int64_t(header->size), std::memory_order_relaxed);
+    std::free(static_cast<uint8_t*>(ptr) - header->offset);
+}
+
+void* tracked_new(size_t size, size_t alignment = alignof(Header))
+{
+    void* ptr = tracked_alloc(size, alignment);
+    while (nullptr == ptr)
+    {
+        std::new_handler handler = std::get_new_handler();
+        if (nullptr == handler)
+        {
+            throw std::bad_alloc();
+        }
+        handler();
+        ptr = tracked_alloc(size, alignment);
+    }
+    return ptr;
+}
+
+size_t stack_high_water_mark(const ThreadStack& stack)
+{
+    const size_t page_size = size_t(sysconf(_SC_PAGESIZE));
+    const size_t pages = stack.size / page_size;
+    unsigned char* residency = static_cast<unsigned char*>(std::malloc(pages));
+    if (nullptr == residency)
+    {
+        return 0;
+    }
+
+    // The stack grows downwards, the lowest resident page is the deepest one reached.
+    size_t deepest = pages;
+    if (0 == mincore(stack.base, stack.size, residency))
+    {
+        for (size_t i = 0; i < pages; ++i)
+        {
+            if (residency[i] & 1)
+            {
+                deepest = i;
+                break;
+            }
+        }
+    }
+    std::free(residency);
+
+    return (pages - deepest) * page_size;
+}
+
+size_t main_stack_bytes()
+{
+    size_t stack_kb = 0;
+    FILE* status = std::fopen("/proc/self/status", "r");
+    if (nullptr != status)
+    {
+        char line[256];
+        while (nullptr != std::fgets(line, sizeof(line), status))
+        {
+            if (1 == std::sscanf(line, "VmStk: %zu kB", &stack_kb))
+            {
+                break;
+            }
+        }
+        std::fclose(status);
+    }
+    return stack_kb * 1024;
+}
+
+void print_counters(std::ostream& os, const Counters& counters)
+{
+    os << "{\"live\": " << counters.live_bytes
+       << ", \"peak\": " << counters.peak_bytes
+       << ", \"allocations\": " << counters.allocations
+       << ", \"deallocations\": " << counters.deallocations << "}";
+}
+
+} // namespace
+
+const char* to_string(Subsystem subsystem)
+{
+    switch (subsystem)
+    {
+        case Subsystem::SESSIONS: return "sessions";
+        case Subsystem::STREAMS: return "streams";
+        case Subsystem::ENTITIES: return "entities";
+        case Subsystem::DATA: return "data";
+        default: return "other";
+    }
+}
+
+void set_subsystem(Subsystem subsystem)
+{
+    current_subsystem.store(uint8_t(subsystem), std::memory_order_relaxed);
+}
+
+Subsystem get_subsystem()
+{
+    return Subsystem(current_subsystem.load(std::memory_order_relaxed));
+}
+
+Counters get_counters(Subsystem subsystem)
+{
+    size_t index = size_t(subsystem);
+    Counters counters;
+    counters.live_bytes = live_bytes[index].load(std::memory_order_relaxed);
+    counters.peak_bytes = peak_bytes[index].load(std::memory_order_relaxed);
+    counters.allocations = allocations[index].load(std::memory_order_relaxed);
+    counters.deallocations = deallocations[index].load(std::memory_order_relaxed);
+    return counters;
+}
+
+Counters get_total_counters()
+{
+    Counters counters = {total_live_bytes.load(), total_peak_bytes.load(), 0, 0};
+    for (size_t i = 0; i < subsystem_count; ++i)
+    {
+        counters.allocations += allocations[i].load(std::memory_order_relaxed);
+        counters.deallocations += deallocations[i].load(std::memory_order_relaxed);
+    }
+    return counters;
+}
+
+StackUsage get_stack_usage()
+{
+    StackUsage usage = {main_stack_bytes(), 0, 0};
+    size_t count = thread_stack_count.load();
+    usage.threads = (max_tracked_stacks < count) ? max_tracked_stacks : count;
+    for (size_t i = 0; i < usage.threads; ++i)
+    {
+        size_t bytes = stack_high_water_mark(thread_stacks[i]);
+        usage.max_thread_bytes = (bytes > usage.max_thread_bytes) ? bytes : usage.max_thread_bytes;
+    }
+    return usage;
+}
+
+void reset_peaks()
+{
+    for (size_t i = 0; i < subsystem_count; ++i)
+    {
+        peak_bytes[i].store(live_bytes[i].load());
+    }
+    total_peak_bytes.store(total_live_bytes.load());
+}
+
+void print_json(std::ostream& os)
+{
+    os << "{\"subsystems\": {";
+    for (size_t i = 0; i < subsystem_count; ++i)
+    {
+        os << ((0 == i) ? "" : ", ") << "\"" << to_string(Subsystem(i)) << "\": ";
+        print_counters(os, get_counters(Subsystem(i)));
+    }
+    os << "}, \"total\": ";
+    print_counters(os, get_total_counters());
+
+    StackUsage stack = get_stack_usage();
+    os << ", \"stack\": {\"main\": " << stack.main_bytes
+       << ", \"max_thread\": " << stack.max_thread_bytes
+       << ", \"threads\": " << stack.threads << "}}";
+}
+
+} // namespace footprint
+
+/*
+ * Counting allocator hook.
+ */
+void* operator new(std::size_t size)
+{
+    return footprint::tracked_new(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return footprint::tracked_new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return footprint::tracked_alloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return footprint::tracked_alloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+#ifdef __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return footprint::tracked_new(size, size_t(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return footprint::tracked_new(size, size_t(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return footprint::tracked_alloc(size, size_t(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return footprint::tracked_alloc(size, size_t(alignment));
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept
+{
+    footprint::tracked_free(ptr);
+}
+#endif // __cpp_aligned_new
+
+/*
+ * Stack high-water-mark probe.
+ * Threads created without attributes get a stack mapped by us, which is never touched beforehand,
+ * so its lowest resident page is the deepest point reached by the thread.
+ * Stacks are kept mapped after the thread exits so they can still be reported.
+ */
+extern "C" int pthread_create(
+        pthread_t* thread,
+        const pthread_attr_t* attr,
+        void* (*start_routine)(void*),
+        void* arg)
+{
+    using PthreadCreate = int (*)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+    static PthreadCreate real_pthread_create = reinterpret_cast<PthreadCreate>(dlsym(RTLD_NEXT, "pthread_create"));
+
+    size_t index = footprint::thread_stack_count.load();
+    if (nullptr != attr || footprint::max_tracked_stacks <= index)
+    {
+        return real_pthread_create(thread, attr, start_routine, arg);
+    }
+
+    pthread_attr_t stack_attr;
+    pthread_attr_init(&stack_attr);
+    size_t stack_size;
+    pthread_attr_getstacksize(&stack_attr, &stack_size);
+
+    const size_t guard_size = size_t(sysconf(_SC_PAGESIZE));
+    void* mapping = mmap(nullptr, stack_size + guard_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_STACK, -1, 0);
+    if (MAP_FAILED == mapping)
+    {
+        pthread_attr_destroy(&stack_attr);
+        return real_pthread_create(thread, attr, start_routine, arg);
+    }
+    mprotect(mapping, guard_size, PROT_NONE);
+
+    uint8_t* base = static_cast<uint8_t*>(mapping) + guard_size;
+    pthread_attr_setstack(&stack_attr, base, stack_size);
+    int rv = real_pthread_create(thread, &stack_attr, start_routine, arg);
+    pthread_attr_destroy(&stack_attr);
+
+    if (0 == rv)
+    {
+        index = footprint::thread_stack_count.fetch_add(1);
+        if (footprint::max_tracked_stacks > index)
+        {
+            footprint::thread_stacks[index].base = base;
+            footprint::thread_stacks[index].size = stack_size;
+        }
+    }
+    else
+    {
+        munmap(mapping, stack_size + guard_size);
+    }
+
+    return rv;
+}
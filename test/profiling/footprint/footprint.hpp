@@ -0,0 +1,101 @@
+// Copyright 2017-present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PROFILING_FOOTPRINT_HPP
+#define PROFILING_FOOTPRINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace footprint {
+
+/**
+ * Subsystem charged for the allocations done while it is active.
+ * The tag is process-wide rather than per-thread, since the Agent serves the requests
+ * from its own threads while the driver waits for the replies.
+ */
+enum class Subsystem : uint8_t
+{
+    OTHER,
+    SESSIONS,
+    STREAMS,
+    ENTITIES,
+    DATA,
+    COUNT
+};
+
+struct Counters
+{
+    int64_t live_bytes;
+    int64_t peak_bytes;
+    uint64_t allocations;
+    uint64_t deallocations;
+};
+
+struct StackUsage
+{
+    size_t main_bytes;
+    size_t max_thread_bytes;
+    size_t threads;
+};
+
+const char* to_string(Subsystem subsystem);
+
+void set_subsystem(Subsystem subsystem);
+
+Subsystem get_subsystem();
+
+Counters get_counters(Subsystem subsystem);
+
+Counters get_total_counters();
+
+/**
+ * Stack high-water marks.
+ * Thread stacks are allocated by the footprint library and measured with mincore,
+ * the main thread stack is read from /proc/self/status.
+ */
+StackUsage get_stack_usage();
+
+void reset_peaks();
+
+void print_json(std::ostream& os);
+
+/**
+ * RAII helper that charges a scope to a subsystem.
+ */
+class ScopedSubsystem
+{
+public:
+    explicit ScopedSubsystem(Subsystem subsystem)
+        : previous_(get_subsystem())
+    {
+        set_subsystem(subsystem);
+    }
+
+    ~ScopedSubsystem()
+    {
+        set_subsystem(previous_);
+    }
+
+    ScopedSubsystem(const ScopedSubsystem&) = delete;
+    ScopedSubsystem& operator =(const ScopedSubsystem&) = delete;
+
+private:
+    Subsystem previous_;
+};
+
+} // namespace footprint
+
+#endif // PROFILING_FOOTPRINT_HPP
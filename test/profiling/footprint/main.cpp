@@ -0,0 +1,221 @@
+// Copyright 2017-present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <footprint.hpp>
+
+#include <uxr/agent/transport/udp/UDPv4AgentLinux.hpp>
+#include <uxr/client/client.h>
+#include <ucdr/microcdr.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define STREAM_HISTORY  2
+#define BUFFER_SIZE     UXR_CONFIG_UDP_TRANSPORT_MTU * STREAM_HISTORY
+
+namespace {
+
+struct FootprintClient
+{
+    uxrUDPTransport transport;
+    uxrSession session;
+    uint8_t output_besteffort_stream_buffer[UXR_CONFIG_UDP_TRANSPORT_MTU];
+    uint8_t output_reliable_stream_buffer[BUFFER_SIZE];
+    uint8_t input_reliable_stream_buffer[BUFFER_SIZE];
+    uxrStreamId besteffort_out;
+    uxrStreamId reliable_out;
+    uxrStreamId besteffort_in;
+    uint32_t received;
+};
+
+void on_topic(
+        uxrSession* session,
+        uxrObjectId object_id,
+        uint16_t request_id,
+        uxrStreamId stream_id,
+        struct ucdrBuffer* ub,
+        uint16_t length,
+        void* args)
+{
+    (void) session; (void) object_id; (void) request_id; (void) stream_id; (void) ub; (void) length;
+
+    ++static_cast<FootprintClient*>(args)->received;
+}
+
+bool create_entities(FootprintClient& client, uint32_t index)
+{
+    uxrSession* session = &client.session;
+    std::string topic_name = "topic_name_" + std::to_string(index);
+
+    uxrObjectId participant_id = uxr_object_id(0x01, UXR_PARTICIPANT_ID);
+    uint16_t participant_req = uxr_buffer_create_participant_ref(session, client.reliable_out, participant_id, 0, "participant_name", UXR_REPLACE);
+
+    uxrObjectId topic_id = uxr_object_id(0x01, UXR_TOPIC_ID);
+    uint16_t topic_req = uxr_buffer_create_topic_ref(session, client.reliable_out, topic_id, participant_id, topic_name.c_str(), UXR_REPLACE);
+
+    uxrObjectId publisher_id = uxr_object_id(0x01, UXR_PUBLISHER_ID);
+    uint16_t publisher_req = uxr_buffer_create_publisher_xml(session, client.reliable_out, publisher_id, participant_id, "", UXR_REPLACE);
+
+    uxrObjectId datawriter_id = uxr_object_id(0x01, UXR_DATAWRITER_ID);
+    uint16_t datawriter_req = uxr_buffer_create_datawriter_xml(session, client.reliable_out, datawriter_id, publisher_id, topic_name.c_str(), UXR_REPLACE);
+
+    uxrObjectId subscriber_id = uxr_object_id(0x01, UXR_SUBSCRIBER_ID);
+    uint16_t subscriber_req = uxr_buffer_create_subscriber_xml(session, client.reliable_out, subscriber_id, participant_id, "", UXR_REPLACE);
+
+    uxrObjectId datareader_id = uxr_object_id(0x01, UXR_DATAREADER_ID);
+    uint16_t datareader_req = uxr_buffer_create_datareader_ref(session, client.reliable_out, datareader_id, subscriber_id, topic_name.c_str(), UXR_REPLACE);
+
+    uint8_t status[6];
+    uint16_t requests[6] = {participant_req, topic_req, publisher_req, datawriter_req, subscriber_req, datareader_req};
+    return uxr_run_session_until_all_status(session, 1000, requests, status, 6);
+}
+
+void print_phase(const char* name)
+{
+    std::cout << "{\"phase\": \"" << name << "\", \"footprint\": ";
+    footprint::print_json(std::cout);
+    std::cout << "}" << std::endl;
+}
+
+} // namespace
+
+int main(int args, char** argv)
+{
+    // CLI
+    if (4 > args)
+    {
+        std::cout << "usage: clients  topic_size  samples" << std::endl;
+        return 0;
+    }
+
+    uint32_t clients = uint32_t(std::atoi(argv[1]));
+    uint32_t topic_size = uint32_t(std::atoi(argv[2]));
+    topic_size = (UXR_CONFIG_UDP_TRANSPORT_MTU / 2 < topic_size) ? UXR_CONFIG_UDP_TRANSPORT_MTU / 2 : topic_size;
+    uint32_t samples = uint32_t(std::atoi(argv[3]));
+
+    // Agent, charged to OTHER.
+    eprosima::uxr::UDPv4Agent agent(2020, eprosima::uxr::Middleware::Kind::CED);
+    agent.start();
+    print_phase("agent");
+
+    std::unique_ptr<FootprintClient[]> pool(new FootprintClient[clients]());
+
+    // Sessions: the Agent creates a ProxyClient per client_key.
+    {
+        footprint::ScopedSubsystem scope(footprint::Subsystem::SESSIONS);
+        for (uint32_t i = 0; i < clients; ++i)
+        {
+            FootprintClient& client = pool[i];
+            if (!uxr_init_udp_transport(&client.transport, UXR_IPv4, "127.0.0.1", "2020"))
+            {
+                std::cerr << "Error at create transport." << std::endl;
+                return 1;
+            }
+
+            uxr_init_session(&client.session, &client.transport.comm, 0xF0000000 + i);
+            uxr_set_topic_callback(&client.session, on_topic, &client);
+            if (!uxr_create_session(&client.session))
+            {
+                std::cerr << "Error at create session." << std::endl;
+                return 1;
+            }
+        }
+    }
+    print_phase("sessions");
+
+    // Streams: the Agent creates its stream state lazily, on the first message of each stream.
+    // Deleting an unknown object primes both streams without creating any entity.
+    {
+        footprint::ScopedSubsystem scope(footprint::Subsystem::STREAMS);
+        for (uint32_t i = 0; i < clients; ++i)
+        {
+            FootprintClient& client = pool[i];
+            client.besteffort_out = uxr_create_output_best_effort_stream(&client.session, client.output_besteffort_stream_buffer, UXR_CONFIG_UDP_TRANSPORT_MTU);
+            client.reliable_out = uxr_create_output_reliable_stream(&client.session, client.output_reliable_stream_buffer, BUFFER_SIZE, STREAM_HISTORY);
+            client.besteffort_in = uxr_create_input_best_effort_stream(&client.session);
+            uxr_create_input_reliable_stream(&client.session, client.input_reliable_stream_buffer, BUFFER_SIZE, STREAM_HISTORY);
+
+            uxrObjectId unknown_id = uxr_object_id(0xFF, UXR_DATAWRITER_ID);
+            uint16_t requests[2] = {
+                uxr_buffer_delete_entity(&client.session, client.reliable_out, unknown_id),
+                uxr_buffer_delete_entity(&client.session, client.besteffort_out, unknown_id)};
+            uint8_t status[2];
+            uxr_run_session_until_all_status(&client.session, 1000, requests, status, 2);
+        }
+    }
+    print_phase("streams");
+
+    // Entities: participant, topic, publisher, datawriter, subscriber and datareader per client.
+    {
+        footprint::ScopedSubsystem scope(footprint::Subsystem::ENTITIES);
+        for (uint32_t i = 0; i < clients; ++i)
+        {
+            if (!create_entities(pool[i], i))
+            {
+                std::cerr << "Error at create entities." << std::endl;
+                return 1;
+            }
+        }
+    }
+    print_phase("entities");
+
+    // Data: every client writes on its own topic and reads it back.
+    {
+        footprint::ScopedSubsystem scope(footprint::Subsystem::DATA);
+        uxrObjectId datawriter_id = uxr_object_id(0x01, UXR_DATAWRITER_ID);
+        uxrObjectId datareader_id = uxr_object_id(0x01, UXR_DATAREADER_ID);
+        std::vector<uint8_t> payload(topic_size, 'A');
+
+        for (uint32_t i = 0; i < clients; ++i)
+        {
+            uxrDeliveryControl delivery_control = {};
+            delivery_control.max_samples = UXR_MAX_SAMPLES_UNLIMITED;
+            uxr_buffer_request_data(&pool[i].session, pool[i].reliable_out, datareader_id, pool[i].besteffort_in, &delivery_control);
+            uxr_run_session_until_confirm_delivery(&pool[i].session, 1000);
+        }
+
+        for (uint32_t s = 0; s < samples; ++s)
+        {
+            for (uint32_t i = 0; i < clients; ++i)
+            {
+                ucdrBuffer ub;
+                if (0 != uxr_prepare_output_stream(&pool[i].session, pool[i].besteffort_out, datawriter_id, &ub, topic_size))
+                {
+                    ucdr_serialize_array_uint8_t(&ub, payload.data(), payload.size());
+                }
+                uxr_run_session_time(&pool[i].session, 1);
+            }
+        }
+
+        for (uint32_t i = 0; i < clients; ++i)
+        {
+            uxr_run_session_time(&pool[i].session, 10);
+        }
+    }
+    print_phase("data");
+
+    // Teardown, releases are charged to the subsystem that allocated.
+    for (uint32_t i = 0; i < clients; ++i)
+    {
+        uxr_delete_session(&pool[i].session);
+        uxr_close_udp_transport(&pool[i].transport);
+    }
+    agent.stop();
+    print_phase("teardown");
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+import json
+import signal
+import subprocess
+import sys
+import time
+from tabulate import tabulate
+
+n_sessions = [1, 10, 100, 1000, 10000]
+transports = ["udp", "tcp"]
+rounds = 20
+topic_size = 1 << 6
+port = 2020
+output_file = sys.argv[1] if len(sys.argv) > 1 else "scaling-results.json"
+
+results = []
+
+for transport in transports:
+    for n in n_sessions:
+        agent_sp = subprocess.Popen(["./install/bin/agent-profiling", transport, str(port)], shell=False)
+        time.sleep(1)
+
+        bench_sp = subprocess.Popen(
+            ["./install/bin/sessions-benchmark", transport, str(port), str(n), str(rounds), str(topic_size), str(agent_sp.pid)],
+            stdout=subprocess.PIPE, universal_newlines=True)
+        out, _ = bench_sp.communicate()
+
+        agent_sp.send_signal(signal.SIGINT)
+        agent_sp.wait()
+
+        for line in out.splitlines():
+            if line.startswith("{"):
+                results.append(json.loads(line))
+
+with open(output_file, "w") as f:
+    json.dump(results, f, indent=2)
+
+table = []
+for r in results:
+    table.append([
+        r["transport"],
+        r["sessions"],
+        r["ready"],
+        r["setup_ms"],
+        round(r["msgs_per_sec"], 1),
+        r["sent"] - r["received"],
+        round(r["agent_cpu_ns_per_sample"] / 1000, 2),
+        r["voluntary_ctxt_switches"] + r["nonvoluntary_ctxt_switches"],
+        round(r["latency_ns"]["p50"] / 1000, 1),
+        round(r["latency_ns"]["p99"] / 1000, 1),
+        round(r["latency_ns"]["p999"] / 1000, 1),
+    ])
+
+table_header = ["transport", "#sessions", "#ready", "setup (ms)", "msgs/s", "lost", "agent CPU/sample (us)", "ctxt switches", "p50 (us)", "p99 (us)", "p999 (us)"]
+print(tabulate(table, headers=table_header))
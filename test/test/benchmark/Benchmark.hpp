@@ -0,0 +1,353 @@
+#ifndef IN_TEST_BENCHMARK_HPP
+#define IN_TEST_BENCHMARK_HPP
+
+#include <Client.hpp>
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Benchmarks write one JSON object per line, to stdout and appended to the file
+ * pointed by UXR_BENCHMARK_OUTPUT when it is set.
+ */
+class BenchmarkReport
+{
+public:
+    explicit BenchmarkReport(const std::string& benchmark)
+    {
+        add("benchmark", benchmark);
+    }
+
+    BenchmarkReport& add(const std::string& key, const std::string& value)
+    {
+        std::string escaped;
+        for (char c : value)
+        {
+            if ('"' == c || '\\' == c)
+            {
+                escaped.push_back('\\');
+            }
+            escaped.push_back(c);
+        }
+        return add_raw(key, "\"" + escaped + "\"");
+    }
+
+    BenchmarkReport& add(const std::string& key, const char* value)
+    {
+        return add(key, std::string(value));
+    }
+
+    template<typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, BenchmarkReport&>::type
+    add(const std::string& key, T value)
+    {
+        std::ostringstream os;
+        os << +value;
+        return add_raw(key, os.str());
+    }
+
+    BenchmarkReport& add_raw(const std::string& key, const std::string& json)
+    {
+        fields_ << (fields_.tellp() > 0 ? ", " : "") << "\"" << key << "\": " << json;
+        return *this;
+    }
+
+    std::string str() const
+    {
+        return "{" + fields_.str() + "}";
+    }
+
+    void write() const
+    {
+        std::string line = str();
+        std::cout << line << std::endl;
+
+        const char* output = std::getenv("UXR_BENCHMARK_OUTPUT");
+        if (nullptr != output)
+        {
+            std::ofstream file(output, std::ios::app);
+            file << line << std::endl;
+        }
+    }
+
+private:
+    std::ostringstream fields_;
+};
+
+/*
+ * Collection of samples summarized as mean, min, max and nearest-rank percentiles.
+ */
+class Samples
+{
+public:
+    void add(double value)
+    {
+        values_.push_back(value);
+        sorted_ = false;
+    }
+
+    size_t size() const
+    {
+        return values_.size();
+    }
+
+    double percentile(double p)
+    {
+        if (values_.empty())
+        {
+            return 0.0;
+        }
+        sort();
+        size_t rank = size_t(p / 100.0 * double(values_.size()) + 0.5);
+        rank = std::min(std::max(rank, size_t(1)), values_.size());
+        return values_[rank - 1];
+    }
+
+    double mean() const
+    {
+        double sum = 0.0;
+        for (double value : values_)
+        {
+            sum += value;
+        }
+        return values_.empty() ? 0.0 : sum / double(values_.size());
+    }
+
+    double sum() const
+    {
+        double sum = 0.0;
+        for (double value : values_)
+        {
+            sum += value;
+        }
+        return sum;
+    }
+
+    std::string to_json()
+    {
+        std::ostringstream os;
+        os << "{\"count\": " << values_.size()
+           << ", \"mean\": " << mean()
+           << ", \"min\": " << percentile(0.0)
+           << ", \"p50\": " << percentile(50.0)
+           << ", \"p99\": " << percentile(99.0)
+           << ", \"p999\": " << percentile(99.9)
+           << ", \"max\": " << percentile(100.0) << "}";
+        return os.str();
+    }
+
+private:
+    void sort()
+    {
+        if (!sorted_)
+        {
+            std::sort(values_.begin(), values_.end());
+            sorted_ = true;
+        }
+    }
+
+    std::vector<double> values_;
+    bool sorted_ = false;
+};
+
+inline const char* to_string(Transport transport)
+{
+    switch (transport)
+    {
+        case Transport::UDP_IPV4_TRANSPORT: return "udp4";
+        case Transport::UDP_IPV6_TRANSPORT: return "udp6";
+        case Transport::TCP_IPV4_TRANSPORT: return "tcp4";
+        case Transport::TCP_IPV6_TRANSPORT: return "tcp6";
+        case Transport::CAN_TRANSPORT: return "can";
+        case Transport::SERIAL_TRANSPORT: return "serial";
+        case Transport::MULTISERIAL_TRANSPORT: return "multiserial";
+        case Transport::CUSTOM_WITH_FRAMING: return "custom_framing";
+        case Transport::CUSTOM_WITHOUT_FRAMING: return "custom";
+        case Transport::BATCHED_UDP_TRANSPORT: return "udp_batched";
+        case Transport::SHARDED_UDP_TRANSPORT: return "udp_sharded";
+        case Transport::IO_URING_UDP_TRANSPORT: return "udp_io_uring";
+        case Transport::IO_URING_TCP_TRANSPORT: return "tcp_io_uring";
+        case Transport::EPOLL_TCP_TRANSPORT: return "tcp_epoll";
+        case Transport::SHARED_MEMORY_TRANSPORT: return "shared_memory";
+        case Transport::EPOLL_MULTISERIAL_TRANSPORT: return "multiserial_epoll";
+        case Transport::BATCHED_CAN_TRANSPORT: return "can_batched";
+    }
+    return "unknown";
+}
+
+inline const char* to_string(MiddlewareKind middleware)
+{
+    return (MiddlewareKind::FASTDDS == middleware) ? "fastdds" : "ced";
+}
+
+inline const char* to_string(XRCECreationMode mode)
+{
+    switch (mode)
+    {
+        case XRCECreationMode::XRCE_XML_CREATION: return "xml";
+        case XRCECreationMode::XRCE_BIN_CREATION: return "bin";
+        case XRCECreationMode::XRCE_REF_CREATION: return "ref";
+    }
+    return "unknown";
+}
+
+inline int64_t elapsed_ns(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+}
+
+/*
+ * Smallest power of two history able to reassemble a payload in a reliable stream.
+ */
+inline uint16_t history_for_payload(size_t payload, size_t mtu)
+{
+    const size_t overhead = 32;
+    size_t slots = payload / (mtu - overhead) + 2;
+    size_t history = 1;
+    while (history < slots && history < 0x8000)
+    {
+        history <<= 1;
+    }
+    return uint16_t(history);
+}
+
+/*
+ * Start line for the threads of a benchmark: they wait on it once set up, and are released all at once.
+ */
+class StartGate
+{
+public:
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_.wait(lock, [&]{ return open_; });
+    }
+
+    void open()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            open_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+/*
+ * CPU time of a set of threads of this process, used to isolate the cost of the Agent threads
+ * from the clients running in the same process. Only available on Linux, elsewhere it is always 0.
+ */
+class ThreadsCpu
+{
+public:
+    // Leaves the threads running at this point out of the snapshots, typically the test thread before starting the Agent.
+    void ignore_running()
+    {
+        ignored_ = running();
+    }
+
+    // Takes the threads running at this point but the ignored ones, typically right after starting the Agent.
+    void snapshot()
+    {
+        threads_.clear();
+        for (const std::string& tid : running())
+        {
+            if (ignored_.end() == std::find(ignored_.begin(), ignored_.end(), tid))
+            {
+                threads_.push_back(tid);
+            }
+        }
+    }
+
+    int64_t cpu_ns() const
+    {
+        int64_t ns = 0;
+#ifdef __linux__
+        for (const std::string& tid : threads_)
+        {
+            ns += thread_cpu_ns(tid);
+        }
+#endif
+        return ns;
+    }
+
+private:
+#ifdef __linux__
+    static int64_t thread_cpu_ns(const std::string& tid)
+    {
+        // The first field of schedstat is the time spent on the CPU, in nanoseconds.
+        std::ifstream schedstat("/proc/self/task/" + tid + "/schedstat");
+        int64_t ns = 0;
+        if (schedstat >> ns)
+        {
+            return ns;
+        }
+
+        // Kernels without schedstat: utime and stime of the stat file, in clock ticks.
+        std::ifstream file("/proc/self/task/" + tid + "/stat");
+        std::string stat;
+        std::getline(file, stat);
+
+        // Fields after the command name, which may contain spaces: state is the 3rd, utime the 14th and stime the 15th.
+        size_t end = stat.rfind(')');
+        if (std::string::npos == end)
+        {
+            return 0;
+        }
+        std::istringstream fields(stat.substr(end + 2));
+        std::string field;
+        int64_t utime = 0;
+        int64_t stime = 0;
+        for (int i = 3; i <= 15 && fields >> field; ++i)
+        {
+            utime = (14 == i) ? std::stoll(field) : utime;
+            stime = (15 == i) ? std::stoll(field) : stime;
+        }
+        return (utime + stime) * (1000000000 / sysconf(_SC_CLK_TCK));
+    }
+#endif // __linux__
+
+    static std::vector<std::string> running()
+    {
+        std::vector<std::string> threads;
+#ifdef __linux__
+        DIR* dir = opendir("/proc/self/task");
+        if (nullptr != dir)
+        {
+            struct dirent* entry;
+            while (nullptr != (entry = readdir(dir)))
+            {
+                if ('.' != entry->d_name[0])
+                {
+                    threads.push_back(entry->d_name);
+                }
+            }
+            closedir(dir);
+        }
+#endif
+        return threads;
+    }
+
+    std::vector<std::string> threads_;
+    std::vector<std::string> ignored_;
+};
+
+#endif // IN_TEST_BENCHMARK_HPP
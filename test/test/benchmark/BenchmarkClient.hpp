@@ -0,0 +1,182 @@
+#ifndef IN_TEST_BENCHMARK_CLIENT_HPP
+#define IN_TEST_BENCHMARK_CLIENT_HPP
+
+#include "Benchmark.hpp"
+
+#include <functional>
+
+/*
+ * Client writing and reading opaque payloads, for any of the test clients (Client, ClientSerial, ClientCan).
+ * Entities are created with the CED middleware, which forwards the payload untouched regardless of the type.
+ */
+template<typename Base>
+class BenchmarkClient : public Base
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using SampleCallback = std::function<void(size_t index, size_t length)>;
+    using PayloadCallback = std::function<void(const uint8_t* data, size_t length)>;
+
+    BenchmarkClient(float lost, uint16_t history)
+        : Base(lost, history)
+    {
+    }
+
+    virtual ~BenchmarkClient()
+    {}
+
+    void init(Transport transport, const char* ip, const char* port)
+    {
+        ASSERT_NO_FATAL_FAILURE(Base::init_transport(transport, ip, port));
+        uxr_set_topic_callback(&this->session_, on_sample_dispatcher, this);
+    }
+
+    void init(const char* dev, uint32_t can_id)
+    {
+        ASSERT_NO_FATAL_FAILURE(Base::init_transport(dev, can_id));
+        uxr_set_topic_callback(&this->session_, on_sample_dispatcher, this);
+    }
+
+    void create_entities(uint8_t id)
+    {
+        ASSERT_NO_FATAL_FAILURE(Base::template create_entities_xml<MiddlewareKind::CED>(id, 0x80, UXR_STATUS_OK, 0));
+    }
+
+    bool write(uint8_t id, uint8_t stream_id_raw, const std::vector<uint8_t>& payload, int timeout = 30000)
+    {
+        uxrStreamId output_stream_id = uxr_stream_id_from_raw(stream_id_raw, UXR_OUTPUT_STREAM);
+        uxrObjectId datawriter_id = uxr_object_id(id, UXR_DATAWRITER_ID);
+
+        ucdrBuffer ub;
+        uint32_t size = uint32_t(payload.size());
+        uint16_t prepared = (size < this->mtu_ - 32)
+            ? uxr_prepare_output_stream(&this->session_, output_stream_id, datawriter_id, &ub, size)
+            : uxr_prepare_output_stream_fragmented(&this->session_, output_stream_id, datawriter_id, &ub, size, flush_session, NULL);
+        if (UXR_INVALID_REQUEST_ID == prepared)
+        {
+            return false;
+        }
+
+        ucdr_serialize_array_uint8_t(&ub, payload.data(), payload.size());
+        if (ub.error)
+        {
+            return false;
+        }
+
+        if (0 != (stream_id_raw & 0x80))
+        {
+            return uxr_run_session_until_confirm_delivery(&this->session_, timeout);
+        }
+
+        uxr_flash_output_streams(&this->session_);
+        return true;
+    }
+
+    /*
+     * Writes a payload that fits in one message without waiting for its acknowledgement.
+     * The session only runs while the reliable history is full, call confirm_delivery at the end.
+     */
+    bool write_pipelined(uint8_t id, uint8_t stream_id_raw, const std::vector<uint8_t>& payload, int timeout = 30000)
+    {
+        uxrStreamId output_stream_id = uxr_stream_id_from_raw(stream_id_raw, UXR_OUTPUT_STREAM);
+        uxrObjectId datawriter_id = uxr_object_id(id, UXR_DATAWRITER_ID);
+
+        ucdrBuffer ub;
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeout);
+        while (UXR_INVALID_REQUEST_ID == uxr_prepare_output_stream(&this->session_, output_stream_id, datawriter_id, &ub, uint32_t(payload.size())))
+        {
+            if (Clock::now() >= deadline)
+            {
+                return false;
+            }
+            uxr_run_session_time(&this->session_, 1);
+        }
+
+        ucdr_serialize_array_uint8_t(&ub, payload.data(), payload.size());
+        uxr_flash_output_streams(&this->session_);
+
+        // Process acknacks without blocking.
+        uxr_run_session_timeout(&this->session_, 0);
+        return !ub.error;
+    }
+
+    bool confirm_delivery(int timeout)
+    {
+        return uxr_run_session_until_confirm_delivery(&this->session_, timeout);
+    }
+
+    uint16_t request(uint8_t id, uint8_t stream_id_raw)
+    {
+        uxrStreamId output_stream_id = uxr_stream_id(0, UXR_RELIABLE_STREAM, UXR_OUTPUT_STREAM);
+        uxrStreamId input_stream_id = uxr_stream_id_from_raw(stream_id_raw, UXR_INPUT_STREAM);
+        uxrObjectId datareader_id = uxr_object_id(id, UXR_DATAREADER_ID);
+
+        uxrDeliveryControl delivery_control = {};
+        delivery_control.max_samples = UXR_MAX_SAMPLES_UNLIMITED;
+        uint16_t request_id = uxr_buffer_request_data(&this->session_, output_stream_id, datareader_id, input_stream_id, &delivery_control);
+        uxr_run_session_until_confirm_delivery(&this->session_, 1000);
+        return request_id;
+    }
+
+    bool wait_samples(size_t number, int timeout)
+    {
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeout);
+        while (received_ < number && Clock::now() < deadline)
+        {
+            uxr_run_session_time(&this->session_, 10);
+        }
+        return received_ >= number;
+    }
+
+    void run_session(int time)
+    {
+        uxr_run_session_time(&this->session_, time);
+    }
+
+    void set_on_sample(const SampleCallback& on_sample)
+    {
+        on_sample_ = on_sample;
+    }
+
+    void set_on_payload(const PayloadCallback& on_payload)
+    {
+        on_payload_ = on_payload;
+    }
+
+    size_t get_received() const
+    {
+        return received_;
+    }
+
+    uint64_t get_received_bytes() const
+    {
+        return received_bytes_;
+    }
+
+private:
+    static void on_sample_dispatcher(uxrSession* session, uxrObjectId object_id, uint16_t request_id, uxrStreamId stream_id, struct ucdrBuffer* ub, uint16_t length, void* args)
+    {
+        (void) session; (void) object_id; (void) request_id; (void) stream_id; (void) length;
+
+        // The length argument is 16 bits wide, fragmented samples are measured on the buffer.
+        size_t size = size_t(ub->final - ub->iterator);
+        BenchmarkClient* client = static_cast<BenchmarkClient*>(args);
+        if (client->on_sample_)
+        {
+            client->on_sample_(client->received_, size);
+        }
+        if (client->on_payload_)
+        {
+            client->on_payload_(ub->iterator, size);
+        }
+        client->received_bytes_ += size;
+        ++client->received_;
+    }
+
+    SampleCallback on_sample_;
+    PayloadCallback on_payload_;
+    size_t received_ = 0;
+    uint64_t received_bytes_ = 0;
+};
+
+#endif // IN_TEST_BENCHMARK_CLIENT_HPP
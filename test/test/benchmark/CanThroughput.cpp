@@ -0,0 +1,260 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+#include "BenchmarkClient.hpp"
+#include "../client_agent/ClientAgentCan.hpp"
+
+/*
+ * Size of the data field of the CAN FD frame carrying a message. The first data byte holds the
+ * message length, and the data is padded to the next length a DLC can encode.
+ */
+inline size_t canfd_data_size(size_t len)
+{
+    static const size_t dlc_sizes[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+    size_t data = len + 1;
+    for (size_t size : dlc_sizes)
+    {
+        if (data <= size)
+        {
+            return size;
+        }
+    }
+    return 64;
+}
+
+/*
+ * Reliable writes from 1..N clients, each one with its own CAN ID, to a reader through the Agent on vcan0.
+ * Every message is one CAN FD frame, so samples larger than the MTU are fragmented over several frames.
+ *
+ * - Frames: frames on the bus in both directions, data and control (acknacks and heartbeats), per second and per sample.
+ * - Latency: time from the write of a sample to its delivery to the reader.
+ * - Bus overhead: CAN FD data bytes, padding included, over the payload delivered.
+ * - Batching: frames per recvmmsg and sendmmsg call of the batched Agent transport.
+ */
+class CanThroughput : public ::testing::TestWithParam<std::tuple<Transport, size_t, size_t>>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    const size_t SAMPLES = 100;
+
+    CanThroughput()
+        : transport_(std::get<0>(GetParam()))
+        , writers_number_(std::get<1>(GetParam()))
+        , topic_size_(std::get<2>(GetParam()))
+        , agent_(MiddlewareKind::CED, transport_)
+        , reader_(0.0f, history_for_payload(topic_size_, UXR_CAN_TRANSPORT_MTU))
+        , frames_(writers_number_ + 1, 0)
+        , data_bytes_(writers_number_ + 1, 0)
+        , writer_data_frames_(writers_number_, 0)
+        , written_(writers_number_, 0)
+    {
+        for (size_t i = 0; i < writers_number_; ++i)
+        {
+            writers_.emplace_back(new BenchmarkClient<ClientCan>(0.0f, history_for_payload(topic_size_, UXR_CAN_TRANSPORT_MTU)));
+        }
+    }
+
+    ~CanThroughput()
+    {}
+
+    void SetUp() override
+    {
+        agent_.start();
+
+        // Reader and writers take the CAN IDs following the Agent one.
+        ASSERT_NO_FATAL_FAILURE(reader_.init(agent_.dev, agent_.can_id + 1));
+        ASSERT_NO_FATAL_FAILURE(reader_.create_entities(1));
+        for (size_t i = 0; i < writers_number_; ++i)
+        {
+            ASSERT_NO_FATAL_FAILURE(writers_[i]->init(agent_.dev, agent_.can_id + 2 + uint32_t(i)));
+            ASSERT_NO_FATAL_FAILURE(writers_[i]->create_entities(1));
+        }
+
+        reader_.request(1, 0x80);
+        reader_.run_session(500);
+    }
+
+    void TearDown() override
+    {
+        for (auto& writer : writers_)
+        {
+            ASSERT_NO_FATAL_FAILURE(writer->close_transport());
+        }
+        ASSERT_NO_FATAL_FAILURE(reader_.close_transport());
+        agent_.stop();
+    }
+
+    void monitor(BenchmarkClient<ClientCan>& client, size_t index)
+    {
+        bool writer = index < writers_number_;
+        client.set_link_monitor([this, index, writer](LinkDirection direction, const uint8_t* buf, size_t len, bool retransmission)
+        {
+            ++frames_[index];
+            data_bytes_[index] += canfd_data_size(len);
+
+            // Data submessages, first or fragments, from the writer reliable stream.
+            if (writer && LinkDirection::OUTPUT == direction && !retransmission && 4 <= len && 0x80 == buf[1])
+            {
+                ++writer_data_frames_[index];
+            }
+        });
+    }
+
+    void publish(size_t index)
+    {
+        start_gate_.wait();
+
+        BenchmarkClient<ClientCan>& writer = *writers_[index];
+        std::vector<uint8_t> payload(topic_size_, 0xAA);
+        for (size_t i = 0; i < SAMPLES; ++i)
+        {
+            int64_t stamp = Clock::now().time_since_epoch().count();
+            std::memcpy(payload.data(), &stamp, sizeof(stamp));
+            if (!writer.write(1, 0x80, payload, 5000))
+            {
+                break;
+            }
+            ++written_[index];
+        }
+    }
+
+    void read()
+    {
+        reader_.set_on_payload([&](const uint8_t* data, size_t length)
+        {
+            if (sizeof(int64_t) <= length)
+            {
+                int64_t stamp;
+                std::memcpy(&stamp, data, sizeof(stamp));
+                latency_ns_.add(double(Clock::now().time_since_epoch().count() - stamp));
+                last_delivery_ = Clock::now();
+            }
+        });
+
+        start_gate_.wait();
+
+        reader_.wait_samples(SAMPLES * writers_number_, 60000);
+    }
+
+protected:
+    Transport transport_;
+    size_t writers_number_;
+    size_t topic_size_;
+    AgentCan agent_;
+    BenchmarkClient<ClientCan> reader_;
+    std::vector<std::unique_ptr<BenchmarkClient<ClientCan>>> writers_;
+
+    StartGate start_gate_;
+
+    std::vector<uint64_t> frames_;
+    std::vector<uint64_t> data_bytes_;
+    std::vector<uint64_t> writer_data_frames_;
+    std::vector<uint64_t> written_;
+    Samples latency_ns_;
+    Clock::time_point last_delivery_;
+};
+
+TEST_P(CanThroughput, ReliableWrites)
+{
+    for (size_t i = 0; i < writers_number_; ++i)
+    {
+        monitor(*writers_[i], i);
+    }
+    monitor(reader_, writers_number_);
+
+    const BatchedCanTransport* batched = agent_.get_batched_can_transport();
+    BatchedCanTransport::Stats stats_begin = {};
+    if (nullptr != batched)
+    {
+        stats_begin = batched->get_stats();
+    }
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(&CanThroughput::read, this);
+    for (size_t i = 0; i < writers_number_; ++i)
+    {
+        threads.emplace_back(&CanThroughput::publish, this, i);
+    }
+
+    Clock::time_point start = Clock::now();
+    start_gate_.open();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    size_t delivered = reader_.get_received();
+    int64_t elapsed = (0 < delivered) ? elapsed_ns(start, last_delivery_) : 0;
+    uint64_t payload_bytes = reader_.get_received_bytes();
+
+    uint64_t frames = 0;
+    uint64_t data_bytes = 0;
+    uint64_t written = 0;
+    uint64_t writer_data_frames = 0;
+    for (size_t i = 0; i <= writers_number_; ++i)
+    {
+        frames += frames_[i];
+        data_bytes += data_bytes_[i];
+    }
+    for (size_t i = 0; i < writers_number_; ++i)
+    {
+        written += written_[i];
+        writer_data_frames += writer_data_frames_[i];
+    }
+
+    BenchmarkReport report("can_throughput");
+    report.add("transport", to_string(transport_))
+        .add("writers", writers_number_)
+        .add("topic_size", topic_size_)
+        .add("mtu", size_t(UXR_CAN_TRANSPORT_MTU))
+        .add("written", written)
+        .add("delivered", delivered)
+        .add("elapsed_ns", elapsed)
+        .add("frames", frames)
+        .add("frames_per_sec", (0 < elapsed) ? double(frames) * 1e9 / double(elapsed) : 0.0)
+        .add("frames_per_sample", (0 < delivered) ? double(frames) / double(delivered) : 0.0)
+        .add("data_frames_per_sample", (0 < written) ? double(writer_data_frames) / double(written) : 0.0)
+        .add("samples_per_sec", (0 < elapsed) ? double(delivered) * 1e9 / double(elapsed) : 0.0)
+        .add("goodput_bytes_per_sec", (0 < elapsed) ? double(payload_bytes) * 1e9 / double(elapsed) : 0.0)
+        .add("bus_data_bytes", data_bytes)
+        .add("bus_overhead", (0 < payload_bytes) ? double(data_bytes) / double(payload_bytes) - 1.0 : 0.0)
+        .add_raw("latency_ns", latency_ns_.to_json());
+
+    if (nullptr != batched)
+    {
+        BatchedCanTransport::Stats stats = batched->get_stats();
+        uint64_t recv_calls = stats.recv_calls - stats_begin.recv_calls;
+        uint64_t send_calls = stats.send_calls - stats_begin.send_calls;
+        report.add("frames_per_recv_call", (0 < recv_calls) ? double(stats.recv_frames - stats_begin.recv_frames) / double(recv_calls) : 0.0)
+            .add("frames_per_send_call", (0 < send_calls) ? double(stats.send_frames - stats_begin.send_frames) / double(send_calls) : 0.0);
+    }
+    report.write();
+
+    EXPECT_EQ(SAMPLES * writers_number_, written);
+    EXPECT_EQ(written, delivered);
+}
+
+#ifdef INSTANTIATE_TEST_SUITE_P
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
+#else
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_CASE_P(x, y, z)
+#endif // ifdef INSTANTIATE_TEST_SUITE_P
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    CanFD,
+    CanThroughput,
+    ::testing::Combine(
+        ::testing::Values(Transport::CAN_TRANSPORT, Transport::BATCHED_CAN_TRANSPORT),
+        ::testing::Values(size_t(1), size_t(4)),
+        ::testing::Values(size_t(8), size_t(32), size_t(256), size_t(1024))));
+
+int main(int args, char** argv)
+{
+    ::testing::InitGoogleTest(&args, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+
+#include "Benchmark.hpp"
+
+#ifdef _WIN32
+#include <uxr/agent/transport/udp/UDPv4AgentWindows.hpp>
+#else
+#include <uxr/agent/transport/udp/UDPv4AgentLinux.hpp>
+#endif
+
+#define LOCAL_HOST_IPV4 "127.0.0.1"
+
+enum class DiscoveryKind
+{
+    UNICAST,
+    MULTICAST
+};
+
+/*
+ * Discovery storm: a number of clients probe for an Agent at the same time, as after a mass reboot.
+ *
+ * - Latency: time from the start of uxr_discovery_agents until the Agent is found, per client.
+ * - Agent CPU: CPU time spent by the Agent threads during the storm.
+ */
+class DiscoveryStorm : public ::testing::TestWithParam<std::tuple<DiscoveryKind, size_t>>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    const uint16_t AGENT_PORT = 2018;
+    const uint16_t DISCOVERY_PORT = eprosima::uxr::DISCOVERY_PORT;
+    const int DISCOVERY_PERIOD = 5000;
+
+    DiscoveryStorm()
+        : kind_(std::get<0>(GetParam()))
+        , clients_(std::get<1>(GetParam()))
+        , agent_(new eprosima::uxr::UDPv4Agent(AGENT_PORT, eprosima::uxr::Middleware::Kind::CED))
+    {
+    }
+
+    ~DiscoveryStorm()
+    {}
+
+    void SetUp() override
+    {
+        agent_threads_.ignore_running();
+        ASSERT_TRUE(agent_->start());
+        // Multicast discovery always targets the default port.
+        ASSERT_TRUE(agent_->enable_discovery(DISCOVERY_PORT));
+        agent_threads_.snapshot();
+    }
+
+    void TearDown() override
+    {
+        agent_->stop();
+    }
+
+    struct Probe
+    {
+        DiscoveryStorm* storm;
+        Clock::time_point start;
+        bool found;
+    };
+
+    static bool on_agent_found(const TransportLocator* locator, void* args)
+    {
+        Probe* probe = static_cast<Probe*>(args);
+        DiscoveryStorm* storm = probe->storm;
+
+        // Other Agents may answer to the multicast probes.
+        if (ADDRESS_FORMAT_MEDIUM != locator->format || storm->AGENT_PORT != locator->_.medium_locator.locator_port)
+        {
+            return false;
+        }
+
+        Clock::time_point now = Clock::now();
+        std::lock_guard<std::mutex> lock(storm->results_mtx_);
+        storm->latency_ns_.add(double(elapsed_ns(probe->start, now)));
+        storm->last_found_ = std::max(storm->last_found_, now);
+        probe->found = true;
+        return true;
+    }
+
+    void probe()
+    {
+        start_gate_.wait();
+
+        Probe probe{this, Clock::now(), false};
+        switch (kind_)
+        {
+            case DiscoveryKind::UNICAST:
+            {
+                TransportLocator locator;
+                uxr_ip_to_locator(LOCAL_HOST_IPV4, DISCOVERY_PORT, UXR_IPv4, &locator);
+                uxr_discovery_agents(1, DISCOVERY_PERIOD, on_agent_found, &probe, &locator, 1);
+                break;
+            }
+            case DiscoveryKind::MULTICAST:
+                uxr_discovery_agents_default(1, DISCOVERY_PERIOD, on_agent_found, &probe);
+                break;
+        }
+    }
+
+protected:
+    DiscoveryKind kind_;
+    size_t clients_;
+    std::unique_ptr<eprosima::uxr::UDPv4Agent> agent_;
+    ThreadsCpu agent_threads_;
+
+    StartGate start_gate_;
+
+    std::mutex results_mtx_;
+    Samples latency_ns_;
+    Clock::time_point last_found_;
+};
+
+TEST_P(DiscoveryStorm, Probes)
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients_; ++i)
+    {
+        threads.emplace_back(&DiscoveryStorm::probe, this);
+    }
+
+    int64_t agent_cpu = agent_threads_.cpu_ns();
+    Clock::time_point start = Clock::now();
+    start_gate_.open();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    agent_cpu = agent_threads_.cpu_ns() - agent_cpu;
+
+    size_t found = latency_ns_.size();
+    int64_t makespan = (0 < found) ? elapsed_ns(start, last_found_) : 0;
+
+    BenchmarkReport("discovery_storm")
+        .add("discovery", (DiscoveryKind::UNICAST == kind_) ? "unicast" : "multicast")
+        .add("clients", clients_)
+        .add("found", found)
+        .add("makespan_ns", makespan)
+        .add("responses_per_sec", (0 < makespan) ? double(found) * 1e9 / double(makespan) : 0.0)
+        .add("agent_cpu_ns", agent_cpu)
+        .add("agent_cpu_ns_per_probe", (0 < found) ? double(agent_cpu) / double(found) : 0.0)
+        .add_raw("latency_ns", latency_ns_.to_json())
+        .write();
+
+    EXPECT_EQ(clients_, found);
+}
+
+#ifdef INSTANTIATE_TEST_SUITE_P
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
+#else
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_CASE_P(x, y, z)
+#endif // ifdef INSTANTIATE_TEST_SUITE_P
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    Storm,
+    DiscoveryStorm,
+    ::testing::Combine(
+        ::testing::Values(DiscoveryKind::UNICAST, DiscoveryKind::MULTICAST),
+        ::testing::Values(size_t(1), size_t(10), size_t(100), size_t(500))));
+
+int main(int args, char** argv)
+{
+    ::testing::InitGoogleTest(&args, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Benchmark.hpp"
+#include "../client_agent/ClientAgentInteraction.hpp"
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+/*
+ * Boot storm: a number of clients create their session and a full entity tree
+ * (participant, topic, publisher, datawriter, subscriber and datareader) at the same time.
+ *
+ * - Session: time to create the session and its streams.
+ * - Entities: time to get the status of the six entities, one round trip each.
+ * - Time to ready: session plus entities, per client.
+ * - Makespan: time until the last client is ready.
+ */
+class EntityCreation : public ::testing::TestWithParam<std::tuple<MiddlewareKind, XRCECreationMode, size_t>>
+{
+public:
+    const uint16_t AGENT_PORT = 2018 + uint16_t(Transport::UDP_IPV4_TRANSPORT);
+
+    EntityCreation()
+        : middleware_(std::get<0>(GetParam()))
+        , creation_mode_(std::get<1>(GetParam()))
+        , agent_(Transport::UDP_IPV4_TRANSPORT, middleware_, AGENT_PORT)
+    {
+        agent_.start();
+
+        size_t clients = std::get<2>(GetParam());
+        for (size_t i = 0; i < clients; ++i)
+        {
+            clients_.emplace_back(new Client(0.0f, 8));
+        }
+        session_.assign(clients, 0);
+    }
+
+    ~EntityCreation()
+    {}
+
+    void TearDown() override
+    {
+        std::vector<std::thread> threads;
+        for (size_t i = 0; i < clients_.size(); ++i)
+        {
+            if (session_[i])
+            {
+                threads.emplace_back(&Client::close_transport, clients_[i].get(), Transport::UDP_IPV4_TRANSPORT);
+            }
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        agent_.stop();
+    }
+
+    template<MiddlewareKind Kind>
+    static void create_entities(Client& client, XRCECreationMode creation_mode)
+    {
+        switch (creation_mode)
+        {
+            case XRCECreationMode::XRCE_XML_CREATION:
+                ASSERT_NO_FATAL_FAILURE(client.create_entities_xml<Kind>(1, 0x80, UXR_STATUS_OK, 0));
+                break;
+            case XRCECreationMode::XRCE_BIN_CREATION:
+                ASSERT_NO_FATAL_FAILURE(client.create_entities_bin<Kind>(1, 0x80, UXR_STATUS_OK, 0));
+                break;
+            case XRCECreationMode::XRCE_REF_CREATION:
+                ASSERT_NO_FATAL_FAILURE(client.create_entities_ref<Kind>(1, 0x80, UXR_STATUS_OK, 0));
+                break;
+        }
+    }
+
+    void boot(size_t index)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        start_gate_.wait();
+
+        Client& client = *clients_[index];
+        std::string port = std::to_string(AGENT_PORT);
+
+        Clock::time_point begin = Clock::now();
+        ASSERT_NO_FATAL_FAILURE(client.init_transport(Transport::UDP_IPV4_TRANSPORT, "127.0.0.1", port.c_str()));
+        Clock::time_point session = Clock::now();
+        session_[index] = 1;
+
+        switch (middleware_)
+        {
+            case MiddlewareKind::FASTDDS:
+                ASSERT_NO_FATAL_FAILURE(create_entities<MiddlewareKind::FASTDDS>(client, creation_mode_));
+                break;
+            case MiddlewareKind::CED:
+                ASSERT_NO_FATAL_FAILURE(create_entities<MiddlewareKind::CED>(client, creation_mode_));
+                break;
+        }
+        Clock::time_point ready = Clock::now();
+
+        std::lock_guard<std::mutex> lock(results_mtx_);
+        session_ns_.add(double(elapsed_ns(begin, session)));
+        entities_ns_.add(double(elapsed_ns(session, ready)));
+        ready_ns_.add(double(elapsed_ns(begin, ready)));
+        last_ready_ = std::max(last_ready_, ready);
+    }
+
+protected:
+    MiddlewareKind middleware_;
+    XRCECreationMode creation_mode_;
+    Agent agent_;
+    std::vector<std::unique_ptr<Client>> clients_;
+    std::vector<uint8_t> session_;
+
+    StartGate start_gate_;
+
+    std::mutex results_mtx_;
+    Samples session_ns_;
+    Samples entities_ns_;
+    Samples ready_ns_;
+    std::chrono::steady_clock::time_point last_ready_;
+};
+
+TEST_P(EntityCreation, BootStorm)
+{
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients_.size(); ++i)
+    {
+        threads.emplace_back(&EntityCreation::boot, this, i);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    start_gate_.open();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    BenchmarkReport("entity_creation")
+        .add("middleware", to_string(middleware_))
+        .add("representation", to_string(creation_mode_))
+        .add("clients", clients_.size())
+        .add("ready", ready_ns_.size())
+        .add("makespan_ns", (0 < ready_ns_.size()) ? elapsed_ns(start, last_ready_) : 0)
+        .add_raw("session_ns", session_ns_.to_json())
+        .add_raw("entities_ns", entities_ns_.to_json())
+        .add_raw("time_to_ready_ns", ready_ns_.to_json())
+        .write();
+
+    EXPECT_EQ(clients_.size(), ready_ns_.size());
+}
+
+#ifdef INSTANTIATE_TEST_SUITE_P
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
+#else
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_CASE_P(x, y, z)
+#endif // ifdef INSTANTIATE_TEST_SUITE_P
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    CED,
+    EntityCreation,
+    ::testing::Combine(
+        ::testing::Values(MiddlewareKind::CED),
+        ::testing::Values(XRCECreationMode::XRCE_XML_CREATION, XRCECreationMode::XRCE_BIN_CREATION, XRCECreationMode::XRCE_REF_CREATION),
+        ::testing::Values(size_t(1), size_t(10), size_t(100), size_t(1000))));
+
+// Every client owns a DDS participant, and a single host runs out of participant ids
+// in the same domain well before 1000 of them.
+GTEST_INSTANTIATE_TEST_MACRO(
+    FastDDS,
+    EntityCreation,
+    ::testing::Combine(
+        ::testing::Values(MiddlewareKind::FASTDDS),
+        ::testing::Values(XRCECreationMode::XRCE_XML_CREATION, XRCECreationMode::XRCE_BIN_CREATION, XRCECreationMode::XRCE_REF_CREATION),
+        ::testing::Values(size_t(1), size_t(10), size_t(100))));
+
+int main(int args, char** argv)
+{
+#ifndef _WIN32
+    // One socket per client.
+    struct rlimit limit;
+    if (0 == getrlimit(RLIMIT_NOFILE, &limit) && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+#endif // _WIN32
+
+    ::testing::InitGoogleTest(&args, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,318 @@
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "BenchmarkClient.hpp"
+#include "../client_agent/ClientAgentInteraction.hpp"
+#ifndef _WIN32
+#include "../client_agent/ClientAgentSerial.hpp"
+#endif
+
+/*
+ * Reliable fragmented writes from one client to another through the Agent.
+ *
+ * - Writer goodput: payload confirmed by the Agent per second.
+ * - Reader goodput: payload delivered to the reader per second.
+ * - Reassembly: time from the last new fragment leaving the writer to the first message of
+ *   the same sample reaching the reader. It covers reassembly and dispatch on the Agent.
+ */
+template<typename ClientType>
+void run_fragmented_throughput(
+        Transport transport,
+        ClientType& publisher,
+        ClientType& subscriber,
+        size_t mtu,
+        size_t payload_size,
+        size_t samples)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::vector<Clock::time_point> last_sent(samples);
+    std::vector<Clock::time_point> first_received(samples);
+    std::vector<Clock::time_point> delivered(samples);
+    size_t writing = 0;
+    bool pending = false;
+    Clock::time_point pending_time;
+
+    publisher.set_link_monitor([&](LinkDirection direction, const uint8_t* buf, size_t len, bool retransmission)
+    {
+        if (LinkDirection::OUTPUT == direction && 4 <= len && 0x80 == buf[1] && !retransmission && writing < samples)
+        {
+            last_sent[writing] = Clock::now();
+        }
+    });
+
+    subscriber.set_link_monitor([&](LinkDirection direction, const uint8_t* buf, size_t len, bool retransmission)
+    {
+        (void) retransmission;
+        if (LinkDirection::INPUT == direction && 4 <= len && 0x80 == buf[1] && !pending)
+        {
+            pending_time = Clock::now();
+            pending = true;
+        }
+    });
+
+    subscriber.set_on_sample([&](size_t index, size_t length)
+    {
+        (void) length;
+        if (index < samples)
+        {
+            Clock::time_point now = Clock::now();
+            first_received[index] = pending ? pending_time : now;
+            delivered[index] = now;
+        }
+        pending = false;
+    });
+
+    subscriber.request(1, 0x80);
+    subscriber.run_session(500);
+    pending = false;
+
+    std::vector<uint8_t> payload(payload_size, 0xAA);
+    LinkStats publisher_stats = publisher.get_output_link_stats();
+    LinkStats subscriber_stats = subscriber.get_input_link_stats();
+    Clock::time_point start = Clock::now();
+    Clock::time_point write_end;
+    size_t confirmed = 0;
+
+    std::thread publisher_thread([&]()
+    {
+        for (writing = 0; writing < samples; ++writing)
+        {
+            if (!publisher.write(1, 0x80, payload))
+            {
+                break;
+            }
+            ++confirmed;
+        }
+        write_end = Clock::now();
+    });
+
+    std::thread subscriber_thread([&]()
+    {
+        subscriber.wait_samples(samples, 60000);
+    });
+
+    publisher_thread.join();
+    subscriber_thread.join();
+
+    size_t received = std::min(subscriber.get_received(), samples);
+    Samples reassembly;
+    for (size_t i = 0; i < received; ++i)
+    {
+        if (first_received[i] > last_sent[i])
+        {
+            reassembly.add(double(elapsed_ns(last_sent[i], first_received[i])));
+        }
+    }
+
+    double write_seconds = double(elapsed_ns(start, write_end)) / 1e9;
+    double read_seconds = (0 < received) ? double(elapsed_ns(start, delivered[received - 1])) / 1e9 : 0.0;
+    uint64_t messages = publisher.get_output_link_stats().messages - publisher_stats.messages;
+
+    BenchmarkReport("fragmented_throughput")
+        .add("transport", to_string(transport))
+        .add("mtu", mtu)
+        .add("payload", payload_size)
+        .add("samples", samples)
+        .add("confirmed", confirmed)
+        .add("delivered", received)
+        .add("writer_goodput_Bps", (0.0 < write_seconds) ? double(confirmed * payload_size) / write_seconds : 0.0)
+        .add("reader_goodput_Bps", (0.0 < read_seconds) ? double(received * payload_size) / read_seconds : 0.0)
+        .add("messages_per_sample", (0 < confirmed) ? double(messages) / double(confirmed) : 0.0)
+        .add("writer_retransmissions", publisher.get_output_link_stats().retransmissions - publisher_stats.retransmissions)
+        .add("agent_retransmissions", subscriber.get_input_link_stats().retransmissions - subscriber_stats.retransmissions)
+        .add_raw("reassembly_ns", reassembly.to_json())
+        .write();
+
+    publisher.set_link_monitor(LinkMonitor());
+    subscriber.set_link_monitor(LinkMonitor());
+
+    ASSERT_EQ(samples, confirmed);
+    EXPECT_EQ(samples, received);
+}
+
+inline size_t mtu_for(Transport transport)
+{
+    switch (transport)
+    {
+        case Transport::UDP_IPV4_TRANSPORT:
+        case Transport::UDP_IPV6_TRANSPORT:
+            return UXR_CONFIG_UDP_TRANSPORT_MTU;
+        case Transport::TCP_IPV4_TRANSPORT:
+        case Transport::TCP_IPV6_TRANSPORT:
+            return UXR_CONFIG_TCP_TRANSPORT_MTU;
+        default:
+            return UXR_CONFIG_CUSTOM_TRANSPORT_MTU;
+    }
+}
+
+// Samples per payload, enough to move a few MB while keeping small payloads statistically meaningful.
+inline size_t samples_for(size_t payload_size)
+{
+    return std::max<size_t>(1, std::min<size_t>(20, (size_t(4) << 20) / payload_size));
+}
+
+class FragmentedThroughput : public ::testing::TestWithParam<std::tuple<Transport, size_t>>
+{
+public:
+    const uint16_t AGENT_PORT = 2018 + uint16_t(std::get<0>(this->GetParam()));
+
+    FragmentedThroughput()
+        : transport_(std::get<0>(GetParam()))
+        , mtu_(mtu_for(transport_))
+        , payload_size_(mtu_ * std::get<1>(GetParam()))
+        , agent_(transport_, MiddlewareKind::CED, AGENT_PORT)
+        , publisher_(0.0f, 16)
+        , subscriber_(0.0f, history_for_payload(payload_size_, mtu_))
+    {
+        agent_.start();
+    }
+
+    ~FragmentedThroughput()
+    {}
+
+    void SetUp() override
+    {
+        std::string port = std::to_string(AGENT_PORT);
+        std::string segment;
+        const char* ip = nullptr;
+        switch (transport_)
+        {
+            case Transport::UDP_IPV4_TRANSPORT:
+            case Transport::TCP_IPV4_TRANSPORT:
+                ip = "127.0.0.1";
+                break;
+            case Transport::UDP_IPV6_TRANSPORT:
+            case Transport::TCP_IPV6_TRANSPORT:
+                ip = "::1";
+                break;
+#ifdef __linux__
+            case Transport::SHARED_MEMORY_TRANSPORT:
+                segment = shared_memory_segment_name(AGENT_PORT);
+                ip = segment.c_str();
+                break;
+#endif
+            default:
+                break;
+        }
+
+        ASSERT_NO_FATAL_FAILURE(publisher_.init(transport_, ip, ip ? port.c_str() : nullptr));
+        ASSERT_NO_FATAL_FAILURE(subscriber_.init(transport_, ip, ip ? port.c_str() : nullptr));
+        ASSERT_NO_FATAL_FAILURE(publisher_.create_entities(1));
+        ASSERT_NO_FATAL_FAILURE(subscriber_.create_entities(1));
+    }
+
+    void TearDown() override
+    {
+        ASSERT_NO_FATAL_FAILURE(publisher_.close_transport(transport_));
+        ASSERT_NO_FATAL_FAILURE(subscriber_.close_transport(transport_));
+        agent_.stop();
+    }
+
+protected:
+    Transport transport_;
+    size_t mtu_;
+    size_t payload_size_;
+    Agent agent_;
+    BenchmarkClient<Client> publisher_;
+    BenchmarkClient<Client> subscriber_;
+};
+
+TEST_P(FragmentedThroughput, ReliableSweep)
+{
+    run_fragmented_throughput(transport_, publisher_, subscriber_, mtu_, payload_size_, samples_for(payload_size_));
+}
+
+#ifndef _WIN32
+class FragmentedThroughputSerial : public ::testing::TestWithParam<std::tuple<Transport, size_t>>
+{
+public:
+    FragmentedThroughputSerial()
+        : transport_(std::get<0>(GetParam()))
+        , payload_size_(UXR_CONFIG_CUSTOM_TRANSPORT_MTU * std::get<1>(GetParam()))
+        , agent_(transport_, MiddlewareKind::CED)
+        , publisher_(0.0f, 4)
+        , subscriber_(0.0f, history_for_payload(payload_size_, UXR_CONFIG_CUSTOM_TRANSPORT_MTU))
+    {
+    }
+
+    ~FragmentedThroughputSerial()
+    {}
+
+    void SetUp() override
+    {
+        agent_.start();
+        agent_.wait_multiserial_open();
+        std::vector<int> masterfd = agent_.getfd_multi();
+
+        for (int fd : masterfd)
+        {
+            grantpt(fd);
+            unlockpt(fd);
+        }
+
+        ASSERT_NO_FATAL_FAILURE(publisher_.init(transport_, ptsname(masterfd[0]), nullptr));
+        ASSERT_NO_FATAL_FAILURE(subscriber_.init(transport_, ptsname(masterfd[1]), nullptr));
+        ASSERT_NO_FATAL_FAILURE(publisher_.create_entities(1));
+        ASSERT_NO_FATAL_FAILURE(subscriber_.create_entities(1));
+    }
+
+    void TearDown() override
+    {
+        ASSERT_NO_FATAL_FAILURE(publisher_.close_transport(transport_));
+        ASSERT_NO_FATAL_FAILURE(subscriber_.close_transport(transport_));
+        agent_.stop();
+    }
+
+protected:
+    Transport transport_;
+    size_t payload_size_;
+    AgentSerial agent_;
+    BenchmarkClient<ClientSerial> publisher_;
+    BenchmarkClient<ClientSerial> subscriber_;
+};
+
+TEST_P(FragmentedThroughputSerial, ReliableSweep)
+{
+    // 115200 bauds, a few samples are enough to reach the steady state.
+    run_fragmented_throughput(transport_, publisher_, subscriber_, size_t(UXR_CONFIG_CUSTOM_TRANSPORT_MTU), payload_size_, 3);
+}
+#endif // _WIN32
+
+#ifdef INSTANTIATE_TEST_SUITE_P
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
+#else
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_CASE_P(x, y, z)
+#endif // ifdef INSTANTIATE_TEST_SUITE_P
+
+// Payload as a multiple of the transport MTU: from one MTU up to 4 MB over 512 B MTUs.
+GTEST_INSTANTIATE_TEST_MACRO(
+    Transports,
+    FragmentedThroughput,
+    ::testing::Combine(
+        ::testing::Values(Transport::UDP_IPV4_TRANSPORT, Transport::TCP_IPV4_TRANSPORT, Transport::CUSTOM_WITHOUT_FRAMING, Transport::CUSTOM_WITH_FRAMING),
+        ::testing::Values(size_t(1), size_t(8), size_t(64), size_t(512), size_t(2048), size_t(8192))));
+
+#ifdef __linux__
+GTEST_INSTANTIATE_TEST_MACRO(
+    SharedMemory,
+    FragmentedThroughput,
+    ::testing::Combine(
+        ::testing::Values(Transport::SHARED_MEMORY_TRANSPORT),
+        ::testing::Values(size_t(1), size_t(8), size_t(64), size_t(512), size_t(2048), size_t(8192))));
+#endif // __linux__
+
+#ifndef _WIN32
+GTEST_INSTANTIATE_TEST_MACRO(
+    Serial,
+    FragmentedThroughputSerial,
+    ::testing::Combine(
+        ::testing::Values(Transport::MULTISERIAL_TRANSPORT),
+        ::testing::Values(size_t(1), size_t(8), size_t(32))));
+#endif // _WIN32
+
+int main(int args, char** argv)
+{
+    ::testing::InitGoogleTest(&args, argv);
+    return RUN_ALL_TESTS();
+}
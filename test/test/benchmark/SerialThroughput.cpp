@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+#include "BenchmarkClient.hpp"
+#include "../client_agent/ClientAgentSerial.hpp"
+
+/*
+ * Size of a message once framed by the serial transport: begin flag, source and remote addresses,
+ * length and CRC, with the flag and escape bytes escaped. The CRC is counted as two bytes,
+ * its escapes are below 1% of the frames.
+ */
+inline size_t serial_frame_size(const uint8_t* buf, size_t len)
+{
+    const uint8_t framing_begin_flag = 0x7E;
+    const uint8_t framing_esc_flag = 0x7D;
+
+    size_t size = 1 + 2 + 2 + len + 2;
+    uint8_t length[2] = {uint8_t(len & 0xFF), uint8_t(len >> 8)};
+    for (uint8_t octet : length)
+    {
+        size += (framing_begin_flag == octet || framing_esc_flag == octet) ? 1 : 0;
+    }
+    for (size_t i = 0; i < len; ++i)
+    {
+        size += (framing_begin_flag == buf[i] || framing_esc_flag == buf[i]) ? 1 : 0;
+    }
+    return size;
+}
+
+/*
+ * Reliable writes from 1..N serial clients multiplexed by a MultiTermiosAgent over pseudo-terminals.
+ * Pseudo-terminals do not pace the bytes at the configured baud rate, so the measured goodput is the
+ * ceiling of the Agent and the framing, to be compared with the line rate of a real UART.
+ *
+ * - Goodput: payload confirmed by the Agent per second, per client and aggregated.
+ * - Framing overhead: framed bytes written by the clients over their XRCE messages.
+ * - Agent CPU: CPU time of the Agent threads per received wire byte, and the number of clients
+ *   at line rate that the Agent could keep up with on one core.
+ */
+class SerialThroughput : public ::testing::TestWithParam<std::tuple<size_t, size_t>>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    const Transport transport = Transport::MULTISERIAL_TRANSPORT;
+    const std::chrono::seconds DURATION{3};
+
+    SerialThroughput()
+        : clients_number_(std::get<0>(GetParam()))
+        , topic_size_(std::get<1>(GetParam()))
+        , agent_(transport, MiddlewareKind::CED, clients_number_)
+        , sent_(clients_number_, 0)
+        , confirmed_(clients_number_, 0)
+        , elapsed_(clients_number_, 0)
+        , xrce_bytes_(clients_number_, 0)
+        , wire_bytes_(clients_number_, 0)
+    {
+        for (size_t i = 0; i < clients_number_; ++i)
+        {
+            clients_.emplace_back(new BenchmarkClient<ClientSerial>(0.0f, 16));
+        }
+    }
+
+    ~SerialThroughput()
+    {}
+
+    void SetUp() override
+    {
+        agent_threads_.ignore_running();
+        agent_.start();
+        agent_.wait_multiserial_open();
+        agent_threads_.snapshot();
+
+        std::vector<int> masterfd = agent_.getfd_multi();
+        for (size_t i = 0; i < clients_number_; ++i)
+        {
+            grantpt(masterfd[i]);
+            unlockpt(masterfd[i]);
+            ASSERT_NO_FATAL_FAILURE(clients_[i]->init(transport, ptsname(masterfd[i]), nullptr));
+            ASSERT_NO_FATAL_FAILURE(clients_[i]->create_entities(1));
+        }
+    }
+
+    void TearDown() override
+    {
+        for (auto& client : clients_)
+        {
+            ASSERT_NO_FATAL_FAILURE(client->close_transport(transport));
+        }
+        agent_.stop();
+    }
+
+    void publish(size_t index)
+    {
+        BenchmarkClient<ClientSerial>& client = *clients_[index];
+        bool measuring = false;
+        client.set_link_monitor([&](LinkDirection direction, const uint8_t* buf, size_t len, bool retransmission)
+        {
+            (void) retransmission;
+            if (measuring && LinkDirection::OUTPUT == direction)
+            {
+                xrce_bytes_[index] += len;
+                wire_bytes_[index] += serial_frame_size(buf, len);
+            }
+        });
+
+        start_gate_.wait();
+
+        std::vector<uint8_t> payload(topic_size_, 0xAA);
+        measuring = true;
+        Clock::time_point begin = Clock::now();
+        Clock::time_point deadline = begin + DURATION;
+        while (Clock::now() < deadline && client.write_pipelined(1, 0x80, payload))
+        {
+            ++sent_[index];
+        }
+        confirmed_[index] = client.confirm_delivery(5000) ? sent_[index] : 0;
+        elapsed_[index] = elapsed_ns(begin, Clock::now());
+        client.set_link_monitor(LinkMonitor());
+    }
+
+protected:
+    size_t clients_number_;
+    size_t topic_size_;
+    AgentSerial agent_;
+    ThreadsCpu agent_threads_;
+    std::vector<std::unique_ptr<BenchmarkClient<ClientSerial>>> clients_;
+
+    StartGate start_gate_;
+
+    std::vector<uint64_t> sent_;
+    std::vector<uint64_t> confirmed_;
+    std::vector<int64_t> elapsed_;
+    std::vector<uint64_t> xrce_bytes_;
+    std::vector<uint64_t> wire_bytes_;
+};
+
+TEST_P(SerialThroughput, ReliableWrites)
+{
+    // 8N1: ten bits on the line per byte.
+    const double line_rate = std::stod(agent_.baudrate) / 10.0;
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients_number_; ++i)
+    {
+        threads.emplace_back(&SerialThroughput::publish, this, i);
+    }
+
+    int64_t agent_cpu = agent_threads_.cpu_ns();
+    Clock::time_point start = Clock::now();
+    start_gate_.open();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    int64_t makespan = elapsed_ns(start, Clock::now());
+    agent_cpu = agent_threads_.cpu_ns() - agent_cpu;
+
+    Samples goodput;
+    uint64_t payload_bytes = 0;
+    uint64_t xrce_bytes = 0;
+    uint64_t wire_bytes = 0;
+    for (size_t i = 0; i < clients_number_; ++i)
+    {
+        uint64_t bytes = confirmed_[i] * topic_size_;
+        goodput.add((0 < elapsed_[i]) ? double(bytes) * 1e9 / double(elapsed_[i]) : 0.0);
+        payload_bytes += bytes;
+        xrce_bytes += xrce_bytes_[i];
+        wire_bytes += wire_bytes_[i];
+    }
+
+    double seconds = double(makespan) / 1e9;
+    double wire_rate = double(wire_bytes) / seconds / double(clients_number_);
+    double agent_bytes_per_cpu_sec = (0 < agent_cpu) ? double(wire_bytes) * 1e9 / double(agent_cpu) : 0.0;
+
+    BenchmarkReport("serial_throughput")
+        .add("clients", clients_number_)
+        .add("topic_size", topic_size_)
+        .add("baudrate", agent_.baudrate)
+        .add("line_rate_bytes_per_sec", line_rate)
+        .add("payload_bytes", payload_bytes)
+        .add("xrce_bytes", xrce_bytes)
+        .add("wire_bytes", wire_bytes)
+        .add("makespan_ns", makespan)
+        .add("goodput_bytes_per_sec", double(payload_bytes) / seconds)
+        .add_raw("client_goodput_bytes_per_sec", goodput.to_json())
+        .add("client_goodput_to_line_rate", goodput.mean() / line_rate)
+        .add("client_wire_rate_to_line_rate", wire_rate / line_rate)
+        .add("protocol_overhead", (0 < payload_bytes) ? double(xrce_bytes - payload_bytes) / double(payload_bytes) : 0.0)
+        .add("framing_overhead", (0 < xrce_bytes) ? double(wire_bytes - xrce_bytes) / double(xrce_bytes) : 0.0)
+        .add("wire_efficiency", (0 < wire_bytes) ? double(payload_bytes) / double(wire_bytes) : 0.0)
+        .add("agent_cpu_ns", agent_cpu)
+        .add("agent_cpu_utilization", double(agent_cpu) / double(makespan))
+        .add("agent_cpu_ns_per_byte", (0 < wire_bytes) ? double(agent_cpu) / double(wire_bytes) : 0.0)
+        .add("agent_clients_at_line_rate", agent_bytes_per_cpu_sec / line_rate)
+        .write();
+
+    for (size_t i = 0; i < clients_number_; ++i)
+    {
+        EXPECT_LT(0u, confirmed_[i]);
+    }
+}
+
+#ifdef INSTANTIATE_TEST_SUITE_P
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
+#else
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_CASE_P(x, y, z)
+#endif // ifdef INSTANTIATE_TEST_SUITE_P
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    MultiSerial,
+    SerialThroughput,
+    ::testing::Combine(
+        ::testing::Values(size_t(1), size_t(2), size_t(4), size_t(8)),
+        ::testing::Values(size_t(16), size_t(128), size_t(400))));
+
+int main(int args, char** argv)
+{
+    ::testing::InitGoogleTest(&args, argv);
+    return RUN_ALL_TESTS();
+}
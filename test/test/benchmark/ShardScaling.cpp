@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+#include "BenchmarkClient.hpp"
+#include <Sharded_udp_agent.hpp>
+
+/*
+ * Throughput of the sharded UDP Agent with 1..N shards, each with its own SO_REUSEPORT socket
+ * and threads, under many clients writing small samples.
+ *
+ * - Throughput: samples confirmed by the Agent per second, and its speedup over one shard.
+ * - Agent CPU: CPU time of the Agent threads per sample.
+ * - Balance: datagrams received by the busiest shard over the mean.
+ */
+class ShardScaling : public ::testing::TestWithParam<size_t>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    const uint16_t AGENT_PORT = 2018 + uint16_t(Transport::SHARDED_UDP_TRANSPORT);
+    const size_t CLIENTS = 128;
+    const size_t TOPIC_SIZE = 50;
+    const std::chrono::seconds DURATION{2};
+
+    ShardScaling()
+        : agent_(AGENT_PORT, GetParam(), eprosima::uxr::Middleware::Kind::CED)
+        , confirmed_(CLIENTS, 0)
+    {
+        for (size_t i = 0; i < CLIENTS; ++i)
+        {
+            clients_.emplace_back(new BenchmarkClient<Client>(0.0f, 16));
+        }
+    }
+
+    ~ShardScaling()
+    {}
+
+    void SetUp() override
+    {
+        agent_threads_.ignore_running();
+        ASSERT_TRUE(agent_.start());
+        agent_threads_.snapshot();
+
+        std::string port = std::to_string(AGENT_PORT);
+        for (auto& client : clients_)
+        {
+            ASSERT_NO_FATAL_FAILURE(client->init(Transport::SHARDED_UDP_TRANSPORT, "127.0.0.1", port.c_str()));
+            ASSERT_NO_FATAL_FAILURE(client->create_entities(1));
+        }
+    }
+
+    void TearDown() override
+    {
+        for (auto& client : clients_)
+        {
+            ASSERT_NO_FATAL_FAILURE(client->close_transport(Transport::SHARDED_UDP_TRANSPORT));
+        }
+        agent_.stop();
+    }
+
+    void publish(size_t index)
+    {
+        start_gate_.wait();
+
+        BenchmarkClient<Client>& client = *clients_[index];
+        std::vector<uint8_t> payload(TOPIC_SIZE, 0xAA);
+        Clock::time_point deadline = Clock::now() + DURATION;
+        uint64_t sent = 0;
+        while (Clock::now() < deadline && client.write_pipelined(1, 0x80, payload))
+        {
+            ++sent;
+        }
+        confirmed_[index] = client.confirm_delivery(5000) ? sent : 0;
+    }
+
+protected:
+    ShardedUDPAgent agent_;
+    ThreadsCpu agent_threads_;
+    std::vector<std::unique_ptr<BenchmarkClient<Client>>> clients_;
+
+    StartGate start_gate_;
+
+    std::vector<uint64_t> confirmed_;
+
+    // Samples per second with one shard, the baseline of the speedup.
+    static double single_shard_rate_;
+};
+
+double ShardScaling::single_shard_rate_ = 0.0;
+
+TEST_P(ShardScaling, ReliableWrites)
+{
+    size_t shards = agent_.get_shards();
+    std::vector<uint64_t> datagrams_begin;
+    for (size_t i = 0; i < shards; ++i)
+    {
+        datagrams_begin.push_back(agent_.get_transport(i).get_stats().recv_datagrams);
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < CLIENTS; ++i)
+    {
+        threads.emplace_back(&ShardScaling::publish, this, i);
+    }
+
+    int64_t agent_cpu = agent_threads_.cpu_ns();
+    Clock::time_point start = Clock::now();
+    start_gate_.open();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    int64_t elapsed = elapsed_ns(start, Clock::now());
+    agent_cpu = agent_threads_.cpu_ns() - agent_cpu;
+
+    uint64_t confirmed = 0;
+    for (uint64_t samples : confirmed_)
+    {
+        confirmed += samples;
+    }
+
+    Samples datagrams;
+    for (size_t i = 0; i < shards; ++i)
+    {
+        datagrams.add(double(agent_.get_transport(i).get_stats().recv_datagrams - datagrams_begin[i]));
+    }
+
+    double rate = double(confirmed) * 1e9 / double(elapsed);
+    if (1 == shards)
+    {
+        single_shard_rate_ = rate;
+    }
+
+    BenchmarkReport("shard_scaling")
+        .add("shards", shards)
+        .add("clients", CLIENTS)
+        .add("topic_size", TOPIC_SIZE)
+        .add("confirmed", confirmed)
+        .add("elapsed_ns", elapsed)
+        .add("samples_per_sec", rate)
+        .add("speedup", (0.0 < single_shard_rate_) ? rate / single_shard_rate_ : 0.0)
+        .add("agent_cpu_ns", agent_cpu)
+        .add("agent_cpu_ns_per_sample", (0 < confirmed) ? double(agent_cpu) / double(confirmed) : 0.0)
+        .add("shard_imbalance", (0.0 < datagrams.mean()) ? datagrams.percentile(100.0) / datagrams.mean() : 0.0)
+        .add_raw("shard_datagrams", datagrams.to_json())
+        .write();
+
+    for (uint64_t samples : confirmed_)
+    {
+        EXPECT_LT(0u, samples);
+    }
+}
+
+#ifdef INSTANTIATE_TEST_SUITE_P
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
+#else
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_CASE_P(x, y, z)
+#endif // ifdef INSTANTIATE_TEST_SUITE_P
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    Shards,
+    ShardScaling,
+    ::testing::Values(size_t(1), size_t(2), size_t(4), size_t(8), size_t(16)));
+
+int main(int args, char** argv)
+{
+    ::testing::InitGoogleTest(&args, argv);
+    return RUN_ALL_TESTS();
+}
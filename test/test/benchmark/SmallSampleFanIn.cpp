@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+
+#include "BenchmarkClient.hpp"
+#include "../client_agent/ClientAgentInteraction.hpp"
+
+/*
+ * Many clients writing small samples to one Agent, the case where the per message cost of the
+ * Agent transport (one syscall per datagram) dominates its CPU usage.
+ *
+ * - Throughput: samples confirmed by the Agent per second.
+ * - Agent CPU: CPU time of the Agent threads per sample.
+ * - Batching: datagrams per recvmmsg and sendmmsg call, for the batched transport.
+ */
+class SmallSampleFanIn : public ::testing::TestWithParam<std::tuple<Transport, size_t>>
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    const uint16_t AGENT_PORT = 2018 + uint16_t(std::get<0>(GetParam()));
+    const size_t TOPIC_SIZE = 50;
+    const std::chrono::seconds DURATION{2};
+
+    SmallSampleFanIn()
+        : transport_(std::get<0>(GetParam()))
+        , clients_number_(std::get<1>(GetParam()))
+        , agent_(transport_, MiddlewareKind::CED, AGENT_PORT)
+        , confirmed_(clients_number_, 0)
+    {
+        for (size_t i = 0; i < clients_number_; ++i)
+        {
+            clients_.emplace_back(new BenchmarkClient<Client>(0.0f, 16));
+        }
+    }
+
+    ~SmallSampleFanIn()
+    {}
+
+    void SetUp() override
+    {
+        agent_threads_.ignore_running();
+        agent_.start();
+        agent_threads_.snapshot();
+
+        std::string port = std::to_string(AGENT_PORT);
+        for (auto& client : clients_)
+        {
+            ASSERT_NO_FATAL_FAILURE(client->init(transport_, "127.0.0.1", port.c_str()));
+            ASSERT_NO_FATAL_FAILURE(client->create_entities(1));
+        }
+    }
+
+    void TearDown() override
+    {
+        for (auto& client : clients_)
+        {
+            ASSERT_NO_FATAL_FAILURE(client->close_transport(transport_));
+        }
+        agent_.stop();
+    }
+
+    void publish(size_t index)
+    {
+        start_gate_.wait();
+
+        BenchmarkClient<Client>& client = *clients_[index];
+        std::vector<uint8_t> payload(TOPIC_SIZE, 0xAA);
+        Clock::time_point deadline = Clock::now() + DURATION;
+        uint64_t sent = 0;
+        while (Clock::now() < deadline && client.write_pipelined(1, 0x80, payload))
+        {
+            ++sent;
+        }
+        confirmed_[index] = client.confirm_delivery(5000) ? sent : 0;
+    }
+
+protected:
+    Transport transport_;
+    size_t clients_number_;
+    Agent agent_;
+    ThreadsCpu agent_threads_;
+    std::vector<std::unique_ptr<BenchmarkClient<Client>>> clients_;
+
+    StartGate start_gate_;
+
+    std::vector<uint64_t> confirmed_;
+};
+
+TEST_P(SmallSampleFanIn, ReliableWrites)
+{
+#ifdef __linux__
+    const BatchedUDPTransport* batched = agent_.get_batched_udp_transport();
+    BatchedUDPTransport::Stats stats_begin = {};
+    if (nullptr != batched)
+    {
+        stats_begin = batched->get_stats();
+    }
+#endif
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < clients_number_; ++i)
+    {
+        threads.emplace_back(&SmallSampleFanIn::publish, this, i);
+    }
+
+    int64_t agent_cpu = agent_threads_.cpu_ns();
+    Clock::time_point start = Clock::now();
+    start_gate_.open();
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    int64_t elapsed = elapsed_ns(start, Clock::now());
+    agent_cpu = agent_threads_.cpu_ns() - agent_cpu;
+
+    uint64_t confirmed = 0;
+    for (uint64_t samples : confirmed_)
+    {
+        confirmed += samples;
+    }
+
+    BenchmarkReport report("small_sample_fan_in");
+    report.add("transport", to_string(transport_))
+        .add("clients", clients_number_)
+        .add("topic_size", TOPIC_SIZE)
+        .add("confirmed", confirmed)
+        .add("elapsed_ns", elapsed)
+        .add("samples_per_sec", double(confirmed) * 1e9 / double(elapsed))
+        .add("agent_cpu_ns", agent_cpu)
+        .add("agent_cpu_ns_per_sample", (0 < confirmed) ? double(agent_cpu) / double(confirmed) : 0.0);
+
+#ifdef __linux__
+    if (nullptr != batched)
+    {
+        BatchedUDPTransport::Stats stats = batched->get_stats();
+        uint64_t recv_calls = stats.recv_calls - stats_begin.recv_calls;
+        uint64_t send_calls = stats.send_calls - stats_begin.send_calls;
+        report.add("datagrams_per_recv_call", (0 < recv_calls) ? double(stats.recv_datagrams - stats_begin.recv_datagrams) / double(recv_calls) : 0.0)
+            .add("datagrams_per_send_call", (0 < send_calls) ? double(stats.send_datagrams - stats_begin.send_datagrams) / double(send_calls) : 0.0);
+    }
+#endif
+    report.write();
+
+    for (uint64_t samples : confirmed_)
+    {
+        EXPECT_LT(0u, samples);
+    }
+}
+
+#ifdef INSTANTIATE_TEST_SUITE_P
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
+#else
+#define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_CASE_P(x, y, z)
+#endif // ifdef INSTANTIATE_TEST_SUITE_P
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    Transports,
+    SmallSampleFanIn,
+    ::testing::Combine(
+        ::testing::Values(Transport::UDP_IPV4_TRANSPORT),
+        ::testing::Values(size_t(16), size_t(128))));
+
+#ifdef __linux__
+GTEST_INSTANTIATE_TEST_MACRO(
+    BatchedTransports,
+    SmallSampleFanIn,
+    ::testing::Combine(
+        ::testing::Values(Transport::BATCHED_UDP_TRANSPORT, Transport::SHARDED_UDP_TRANSPORT),
+        ::testing::Values(size_t(16), size_t(128))));
+#endif // __linux__
+
+#ifdef UXR_TEST_IO_URING
+GTEST_INSTANTIATE_TEST_MACRO(
+    IoUringTransports,
+    SmallSampleFanIn,
+    ::testing::Combine(
+        ::testing::ValuesIn(io_uring_transports()),
+        ::testing::Values(size_t(16), size_t(128))));
+#endif // UXR_TEST_IO_URING
+
+int main(int args, char** argv)
+{
+    ::testing::InitGoogleTest(&args, argv);
+    return RUN_ALL_TESTS();
+}
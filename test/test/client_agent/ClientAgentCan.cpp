@@ -18,4 +18,13 @@ TEST_P(ClientAgentCan, PingFromClientToAgent)
 GTEST_INSTANTIATE_TEST_MACRO(
     CanTransports,
     ClientAgentCan,
-    ::testing::Values(MiddlewareKind::FASTDDS));
\ No newline at end of file
+    ::testing::Combine(
+        ::testing::Values(Transport::CAN_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS)));
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    BatchedCanTransports,
+    ClientAgentCan,
+    ::testing::Combine(
+        ::testing::Values(Transport::BATCHED_CAN_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED)));
\ No newline at end of file
@@ -2,7 +2,9 @@
 #define IN_TEST_CLIENTCAN_INT_HPP
 
 #include <uxr/agent/transport/can/CanAgentLinux.hpp>
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
 #include <ClientCan.hpp>
+#include <Batched_can_transport.hpp>
 #include <fcntl.h>
 #include <stdlib.h>
 #include <sys/ioctl.h>
@@ -14,8 +16,10 @@ public:
     const char * dev = "vcan0";
     const uint32_t can_id = 0x00000001; // TODO: test different can_id
 
-    AgentCan(MiddlewareKind middleware)
-        : middleware_{}
+    AgentCan(MiddlewareKind middleware,
+          Transport transport = Transport::CAN_TRANSPORT)
+        : transport_(transport)
+        , middleware_{}
     {
         switch (middleware)
         {
@@ -49,27 +53,73 @@ public:
             ASSERT_TRUE(0 == system("ip link add dev vcan0 type vcan && ip link set vcan0 mtu 72 && ip link set dev vcan0 up"));
         }
 
-        agent_can_.reset(new eprosima::uxr::CanAgent(dev, can_id, middleware_));
-        agent_can_->set_verbose_level(6);
-        ASSERT_TRUE(agent_can_->start());
+        switch (transport_)
+        {
+            case Transport::BATCHED_CAN_TRANSPORT:
+            {
+                BatchedCanTransport::add_members(agent_batched_can_endpoint_);
+                batched_can_.reset(new BatchedCanTransport(dev, can_id));
+
+                agent_custom_.reset(new eprosima::uxr::CustomAgent(
+                    "batched_can_agent",
+                    &agent_batched_can_endpoint_,
+                    middleware_,
+                    false,
+                    batched_can_->open,
+                    batched_can_->close,
+                    batched_can_->write,
+                    batched_can_->read));
+                agent_custom_->set_verbose_level(6);
+                ASSERT_TRUE(agent_custom_->start());
+                break;
+            }
+            default:
+            {
+                agent_can_.reset(new eprosima::uxr::CanAgent(dev, can_id, middleware_));
+                agent_can_->set_verbose_level(6);
+                ASSERT_TRUE(agent_can_->start());
+                break;
+            }
+        }
     }
 
     void stop()
     {
-        ASSERT_TRUE(agent_can_->stop());
+        switch (transport_)
+        {
+            case Transport::BATCHED_CAN_TRANSPORT:
+            {
+                ASSERT_TRUE(agent_custom_->stop());
+                break;
+            }
+            default:
+            {
+                ASSERT_TRUE(agent_can_->stop());
+                break;
+            }
+        }
+    }
+
+    BatchedCanTransport* get_batched_can_transport()
+    {
+        return batched_can_.get();
     }
 
 private:
+    Transport transport_;
     std::unique_ptr<eprosima::uxr::CanAgent> agent_can_;
+    std::unique_ptr<BatchedCanTransport> batched_can_;
+    eprosima::uxr::CustomEndPoint agent_batched_can_endpoint_;
+    std::unique_ptr<eprosima::uxr::CustomAgent> agent_custom_;
     eprosima::uxr::Middleware::Kind middleware_;
 };
 
-class ClientAgentCan : public ::testing::TestWithParam<MiddlewareKind>
+class ClientAgentCan : public ::testing::TestWithParam<std::tuple<Transport, MiddlewareKind>>
 {
 public:
     ClientAgentCan()
         : client_can_(0.0f, 8)
-        , agent_(GetParam())
+        , agent_(std::get<1>(GetParam()), std::get<0>(GetParam()))
     {}
 
     ~ClientAgentCan()
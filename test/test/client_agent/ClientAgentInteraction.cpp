@@ -3,10 +3,18 @@
 
 #include <Client.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <memory>
 #include <thread>
 
 #include "ClientAgentInteraction.hpp"
 
+#ifdef __linux__
+#include <sys/wait.h>
+#include <unistd.h>
+#endif // __linux__
+
 
 TEST_P(ClientAgentInteraction, InitCloseSession)
 {
@@ -304,6 +312,254 @@ TEST_P(ClientAgentInteraction, PingFromClientToAgent)
     ASSERT_NO_FATAL_FAILURE(client_.ping_agent(transport_kind));
 }
 
+#ifdef __linux__
+/*
+ * Clients with session ids below 128 carry their key in every message header, which the sharded Agent
+ * steers to the shard key % SHARDS. Clients are created one at a time, so only the shard steered to sees datagrams.
+ */
+TEST(ClientAgentShardedUDP, ClientKeySteering)
+{
+    const uint16_t agent_port = 2018 + uint16_t(Transport::SHARDED_UDP_TRANSPORT);
+    const std::string port = std::to_string(agent_port);
+
+    Agent agent(Transport::SHARDED_UDP_TRANSPORT, MiddlewareKind::CED, agent_port);
+    ASSERT_NO_FATAL_FAILURE(agent.start());
+    const ShardedUDPAgent& sharded = *agent.get_sharded_udp_agent();
+    ASSERT_EQ(Agent::SHARDS, sharded.get_shards());
+
+    std::vector<std::unique_ptr<Client>> clients;
+    for (size_t i = 0; i < 2 * Agent::SHARDS; ++i)
+    {
+        std::vector<uint64_t> received(Agent::SHARDS);
+        for (size_t shard = 0; shard < Agent::SHARDS; ++shard)
+        {
+            received[shard] = sharded.get_transport(shard).get_stats().recv_datagrams;
+        }
+
+        clients.emplace_back(new Client(0.0f, 8));
+        Client& client = *clients.back();
+        client.set_session_id(0x01);
+        ASSERT_NO_FATAL_FAILURE(client.init_transport(Transport::SHARDED_UDP_TRANSPORT, "127.0.0.1", port.c_str()));
+        ASSERT_NO_FATAL_FAILURE(client.create_entities_xml<MiddlewareKind::CED>(1, 0x80, UXR_STATUS_OK, 0));
+
+        size_t expected = client.get_client_key() % Agent::SHARDS;
+        for (size_t shard = 0; shard < Agent::SHARDS; ++shard)
+        {
+            received[shard] = sharded.get_transport(shard).get_stats().recv_datagrams - received[shard];
+            if (expected == shard)
+            {
+                EXPECT_LT(0u, received[shard]) << "client key " << client.get_client_key();
+            }
+            else
+            {
+                EXPECT_EQ(0u, received[shard]) << "client key " << client.get_client_key() << " on shard " << shard;
+            }
+        }
+    }
+
+    for (auto& client : clients)
+    {
+        ASSERT_NO_FATAL_FAILURE(client->close_transport(Transport::SHARDED_UDP_TRANSPORT));
+    }
+    ASSERT_NO_FATAL_FAILURE(agent.stop());
+}
+
+/*
+ * The rings are writable by the Client. A length prefix taking the message past the ring must not be
+ * copied out by the Agent, which closes the slot and gives it to the next Client instead.
+ */
+TEST(ClientAgentSharedMemory, CorruptLengthPrefixClosesSlot)
+{
+    const std::string name = shared_memory_segment_name(2018 + uint16_t(Transport::SHARED_MEMORY_TRANSPORT) + 100);
+    SharedMemoryAgentTransport agent(name, 1);
+    ASSERT_TRUE(agent.open());
+    eprosima::uxr::CustomEndPoint endpoint;
+    SharedMemoryAgentTransport::add_members(endpoint);
+
+    SharedMemoryClient client;
+    ASSERT_TRUE(client.open(name.c_str()));
+    uint8_t* message = client.reserve(8);
+    ASSERT_NE(nullptr, message);
+    client.commit(8);
+    const uint32_t corrupt_length = 0xFFFF0000;
+    std::memcpy(message - sizeof(corrupt_length), &corrupt_length, sizeof(corrupt_length));
+
+    uint8_t buffer[64];
+    eprosima::uxr::TransportRc transport_rc;
+    EXPECT_EQ(0, agent.read(&endpoint, buffer, sizeof(buffer), 100, transport_rc));
+    EXPECT_EQ(eprosima::uxr::TransportRc::timeout_error, transport_rc);
+
+    SharedMemoryClient next;
+    EXPECT_TRUE(next.open(name.c_str()));
+    ASSERT_TRUE(next.close());
+    ASSERT_TRUE(agent.close());
+}
+
+// Serializes a message straight into the ring to the Agent, with no staging buffer.
+static size_t serialize_into_ring(SharedMemoryClient& client, uint32_t sequence, const std::vector<uint8_t>& payload)
+{
+    const size_t capacity = sizeof(uint32_t) + sizeof(uint32_t) + payload.size();
+    uint8_t* message = client.reserve(capacity);
+    if (nullptr == message)
+    {
+        return 0;
+    }
+
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, message, capacity);
+    ucdr_serialize_uint32_t(&ub, sequence);
+    ucdr_serialize_sequence_uint8_t(&ub, payload.data(), uint32_t(payload.size()));
+    client.commit(ucdr_buffer_length(&ub));
+    return ucdr_buffer_length(&ub);
+}
+
+/*
+ * Messages serialized in place through reserve and commit reach the Agent byte for byte as those
+ * serialized into a buffer and written, contiguous or gathered. The sizes wrap the ring several times.
+ */
+TEST(ClientAgentSharedMemory, SerializeIntoRing)
+{
+    const std::string name = shared_memory_segment_name(2018 + uint16_t(Transport::SHARED_MEMORY_TRANSPORT) + 102);
+    SharedMemoryAgentTransport agent(name, 1);
+    ASSERT_TRUE(agent.open());
+    eprosima::uxr::CustomEndPoint endpoint;
+    SharedMemoryAgentTransport::add_members(endpoint);
+
+    SharedMemoryClient client;
+    ASSERT_TRUE(client.open(name.c_str()));
+
+    std::vector<uint8_t> received(4096);
+    eprosima::uxr::TransportRc transport_rc;
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        std::vector<uint8_t> payload(1 + (i * 37) % 1500, uint8_t(i));
+
+        std::vector<uint8_t> expected(sizeof(uint32_t) + sizeof(uint32_t) + payload.size());
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, expected.data(), expected.size());
+        ucdr_serialize_uint32_t(&ub, i);
+        ucdr_serialize_sequence_uint8_t(&ub, payload.data(), uint32_t(payload.size()));
+        expected.resize(ucdr_buffer_length(&ub));
+
+        ASSERT_EQ(expected.size(), serialize_into_ring(client, i, payload));
+        ssize_t length = agent.read(&endpoint, received.data(), received.size(), 1000, transport_rc);
+        ASSERT_EQ(ssize_t(expected.size()), length);
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), received.begin())) << "message " << i;
+
+        ASSERT_EQ(expected.size(), client.write(expected.data(), expected.size()));
+        length = agent.read(&endpoint, received.data(), received.size(), 1000, transport_rc);
+        ASSERT_EQ(ssize_t(expected.size()), length);
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), received.begin())) << "message " << i;
+
+        const custom_transport_slice slices[] = {
+            {expected.data(), sizeof(uint32_t)},
+            {expected.data() + sizeof(uint32_t), expected.size() - sizeof(uint32_t)},
+        };
+        ASSERT_EQ(expected.size(), client.writev(slices, 2));
+        length = agent.read(&endpoint, received.data(), received.size(), 1000, transport_rc);
+        ASSERT_EQ(ssize_t(expected.size()), length);
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), received.begin())) << "message " << i;
+    }
+
+    ASSERT_TRUE(client.close());
+    ASSERT_TRUE(agent.close());
+}
+
+/*
+ * The vectored send gathers the slices of a message with one sendmsg. The receiver must get the same
+ * datagram as from the contiguous write, whatever the slice boundaries, empty slices included.
+ */
+TEST(ClientAgentBatchedUDP, VectoredSendDeliversSameBytes)
+{
+    BatchedUDPTransport transport(2018 + uint16_t(Transport::BATCHED_UDP_TRANSPORT) + 100, 32, std::chrono::microseconds(0));
+    ASSERT_TRUE(transport.open());
+
+    int receiver = socket(AF_INET6, SOCK_DGRAM, 0);
+    ASSERT_NE(-1, receiver);
+    struct sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_addr = in6addr_loopback;
+    ASSERT_EQ(0, bind(receiver, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)));
+    socklen_t address_length = sizeof(address);
+    ASSERT_EQ(0, getsockname(receiver, reinterpret_cast<struct sockaddr*>(&address), &address_length));
+    struct timeval timeout = {1, 0};
+    ASSERT_EQ(0, setsockopt(receiver, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+
+    eprosima::uxr::CustomEndPoint endpoint;
+    BatchedUDPTransport::add_members(endpoint);
+    uint64_t high;
+    uint64_t low;
+    std::memcpy(&high, &address.sin6_addr.s6_addr[0], sizeof(high));
+    std::memcpy(&low, &address.sin6_addr.s6_addr[8], sizeof(low));
+    endpoint.set_member_value<uint64_t>("address_high", high);
+    endpoint.set_member_value<uint64_t>("address_low", low);
+    endpoint.set_member_value<uint16_t>("port", ntohs(address.sin6_port));
+
+    std::vector<uint8_t> received(4096);
+    eprosima::uxr::TransportRc transport_rc;
+    for (size_t i = 0; i < 64; ++i)
+    {
+        std::vector<uint8_t> message(8 + (i * 37) % 1400);
+        for (size_t j = 0; j < message.size(); ++j)
+        {
+            message[j] = uint8_t(i + j);
+        }
+
+        ASSERT_EQ(ssize_t(message.size()), transport.write(&endpoint, message.data(), message.size(), transport_rc));
+        ASSERT_EQ(ssize_t(message.size()), ::recv(receiver, received.data(), received.size(), 0));
+        EXPECT_TRUE(std::equal(message.begin(), message.end(), received.begin())) << "write " << i;
+
+        // Header, subheader and payload, as the session builds a message.
+        size_t header = std::min(i % 5, message.size());
+        size_t subheader = std::min(size_t(4), message.size() - header);
+        const custom_transport_slice slices[] = {
+            {message.data(), header},
+            {message.data() + header, subheader},
+            {message.data() + header + subheader, message.size() - header - subheader},
+        };
+        ASSERT_EQ(ssize_t(message.size()), transport.writev(&endpoint, slices, 3, transport_rc));
+        ASSERT_EQ(eprosima::uxr::TransportRc::ok, transport_rc);
+        ASSERT_EQ(ssize_t(message.size()), ::recv(receiver, received.data(), received.size(), 0));
+        EXPECT_TRUE(std::equal(message.begin(), message.end(), received.begin())) << "writev " << i;
+    }
+
+    EXPECT_EQ(128u, transport.get_stats().send_datagrams);
+    ::close(receiver);
+    ASSERT_TRUE(transport.close());
+}
+
+// A Client process exiting without closing its slot must not keep it taken.
+TEST(ClientAgentSharedMemory, SlotOfExitedClientIsReclaimed)
+{
+    const std::string name = shared_memory_segment_name(2018 + uint16_t(Transport::SHARED_MEMORY_TRANSPORT) + 101);
+    SharedMemoryAgentTransport agent(name, 1);
+    ASSERT_TRUE(agent.open());
+    eprosima::uxr::CustomEndPoint endpoint;
+    SharedMemoryAgentTransport::add_members(endpoint);
+
+    pid_t pid = fork();
+    ASSERT_NE(-1, pid);
+    if (0 == pid)
+    {
+        SharedMemoryClient client;
+        _exit(client.open(name.c_str()) ? 0 : 1);
+    }
+    int status = 0;
+    ASSERT_EQ(pid, waitpid(pid, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status) && 0 == WEXITSTATUS(status));
+
+    SharedMemoryClient next;
+    EXPECT_FALSE(next.open(name.c_str()));
+
+    uint8_t buffer[64];
+    eprosima::uxr::TransportRc transport_rc;
+    agent.read(&endpoint, buffer, sizeof(buffer), 100, transport_rc);
+    EXPECT_TRUE(next.open(name.c_str()));
+    ASSERT_TRUE(next.close());
+    ASSERT_TRUE(agent.close());
+}
+#endif // __linux__
+
 #ifdef INSTANTIATE_TEST_SUITE_P
 #define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
 #else
@@ -324,6 +580,38 @@ GTEST_INSTANTIATE_TEST_MACRO(
         ::testing::Values(Transport::CUSTOM_WITHOUT_FRAMING, Transport::CUSTOM_WITH_FRAMING),
         ::testing::Values(MiddlewareKind::FASTDDS)));
 
+#ifdef __linux__
+GTEST_INSTANTIATE_TEST_MACRO(
+    BatchedTransports,
+    ClientAgentInteraction,
+    ::testing::Combine(
+        ::testing::Values(Transport::BATCHED_UDP_TRANSPORT, Transport::SHARDED_UDP_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED)));
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    EpollTransports,
+    ClientAgentInteraction,
+    ::testing::Combine(
+        ::testing::Values(Transport::EPOLL_TCP_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED)));
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    SharedMemoryTransports,
+    ClientAgentInteraction,
+    ::testing::Combine(
+        ::testing::Values(Transport::SHARED_MEMORY_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED)));
+#endif // __linux__
+
+#ifdef UXR_TEST_IO_URING
+GTEST_INSTANTIATE_TEST_MACRO(
+    IoUringTransports,
+    ClientAgentInteraction,
+    ::testing::Combine(
+        ::testing::ValuesIn(io_uring_transports()),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED)));
+#endif // UXR_TEST_IO_URING
+
 int main(int args, char** argv)
 {
     ::testing::InitGoogleTest(&args, argv);
@@ -14,10 +14,22 @@
 #endif
 
 #include <uxr/agent/transport/custom/CustomAgent.hpp>
+#ifdef __linux__
+#include <Batched_udp_transport.hpp>
+#include <Sharded_udp_agent.hpp>
+#include <Epoll_tcp_transport.hpp>
+#include <Shared_memory_transport.hpp>
+#endif
+#ifdef UXR_TEST_IO_URING
+#include <Io_uring_transport.hpp>
+#endif
 
 class Agent
 {
 public:
+    // Shards of the SHARDED_UDP_TRANSPORT Agent.
+    static const size_t SHARDS = 4;
+
     Agent(Transport transport,
           MiddlewareKind middleware,
           const uint16_t port)
@@ -120,7 +132,95 @@ public:
                 ASSERT_TRUE(agent_custom_->start());
                 break;
             }
+#ifdef __linux__
+            case Transport::BATCHED_UDP_TRANSPORT:
+            {
+                BatchedUDPTransport::add_members(agent_batched_udp_endpoint_);
+                batched_udp_.reset(new BatchedUDPTransport(port_));
+
+                agent_custom_.reset(new eprosima::uxr::CustomAgent(
+                    "batched_udp_agent",
+                    &agent_batched_udp_endpoint_,
+                    middleware_,
+                    false,
+                    batched_udp_->open,
+                    batched_udp_->close,
+                    batched_udp_->write,
+                    batched_udp_->read));
+                agent_custom_->set_verbose_level(6);
+                ASSERT_TRUE(agent_custom_->start());
+                break;
+            }
+            case Transport::SHARDED_UDP_TRANSPORT:
+            {
+                agent_sharded_udp_.reset(new ShardedUDPAgent(port_, SHARDS, middleware_));
+                agent_sharded_udp_->set_verbose_level(6);
+                ASSERT_TRUE(agent_sharded_udp_->start());
+                break;
+            }
+            case Transport::EPOLL_TCP_TRANSPORT:
+            {
+                EpollTCPTransport::add_members(agent_epoll_tcp_endpoint_);
+                epoll_tcp_.reset(new EpollTCPTransport(port_));
+
+                agent_custom_.reset(new eprosima::uxr::CustomAgent(
+                    "epoll_tcp_agent",
+                    &agent_epoll_tcp_endpoint_,
+                    middleware_,
+                    false,
+                    epoll_tcp_->open,
+                    epoll_tcp_->close,
+                    epoll_tcp_->write,
+                    epoll_tcp_->read));
+                agent_custom_->set_verbose_level(6);
+                ASSERT_TRUE(agent_custom_->start());
+                break;
+            }
+            case Transport::SHARED_MEMORY_TRANSPORT:
+            {
+                SharedMemoryAgentTransport::add_members(agent_shared_memory_endpoint_);
+                shared_memory_.reset(new SharedMemoryAgentTransport(shared_memory_segment_name(port_)));
+
+                agent_custom_.reset(new eprosima::uxr::CustomAgent(
+                    "shared_memory_agent",
+                    &agent_shared_memory_endpoint_,
+                    middleware_,
+                    false,
+                    shared_memory_->open,
+                    shared_memory_->close,
+                    shared_memory_->write,
+                    shared_memory_->read));
+                agent_custom_->set_verbose_level(6);
+                ASSERT_TRUE(agent_custom_->start());
+                break;
+            }
+#endif
+#ifdef UXR_TEST_IO_URING
+            case Transport::IO_URING_UDP_TRANSPORT:
+            case Transport::IO_URING_TCP_TRANSPORT:
+            {
+                IoUringTransport::add_members(agent_io_uring_endpoint_);
+                io_uring_.reset(new IoUringTransport(
+                    (Transport::IO_URING_UDP_TRANSPORT == transport_) ? IoUringTransport::Protocol::UDP : IoUringTransport::Protocol::TCP,
+                    port_));
 
+                agent_custom_.reset(new eprosima::uxr::CustomAgent(
+                    "io_uring_agent",
+                    &agent_io_uring_endpoint_,
+                    middleware_,
+                    false,
+                    io_uring_->open,
+                    io_uring_->close,
+                    io_uring_->write,
+                    io_uring_->read));
+                agent_custom_->set_verbose_level(6);
+                ASSERT_TRUE(agent_custom_->start());
+                break;
+            }
+#endif
+            default:
+                FAIL() << "Transport type not supported";
+                break;
         }
     }
 
@@ -150,19 +250,64 @@ public:
             }
             case Transport::CUSTOM_WITHOUT_FRAMING:
             case Transport::CUSTOM_WITH_FRAMING:
+            case Transport::BATCHED_UDP_TRANSPORT:
+            case Transport::IO_URING_UDP_TRANSPORT:
+            case Transport::IO_URING_TCP_TRANSPORT:
+            case Transport::EPOLL_TCP_TRANSPORT:
+            case Transport::SHARED_MEMORY_TRANSPORT:
             {
                 ASSERT_TRUE(agent_custom_->stop());
                 break;
             }
+#ifdef __linux__
+            case Transport::SHARDED_UDP_TRANSPORT:
+            {
+                ASSERT_TRUE(agent_sharded_udp_->stop());
+                break;
+            }
+#endif
+            default:
+                break;
         }
     }
 
+#ifdef __linux__
+    const BatchedUDPTransport* get_batched_udp_transport() const
+    {
+        return batched_udp_.get();
+    }
+
+    const EpollTCPTransport* get_epoll_tcp_transport() const
+    {
+        return epoll_tcp_.get();
+    }
+
+    const ShardedUDPAgent* get_sharded_udp_agent() const
+    {
+        return agent_sharded_udp_.get();
+    }
+#endif
+
 private:
     Transport transport_;
     std::unique_ptr<eprosima::uxr::UDPv4Agent> agent_udp4_;
     std::unique_ptr<eprosima::uxr::UDPv6Agent> agent_udp6_;
     std::unique_ptr<eprosima::uxr::TCPv4Agent> agent_tcp4_;
     std::unique_ptr<eprosima::uxr::TCPv6Agent> agent_tcp6_;
+#ifdef __linux__
+    // Declared before the Agent, which keeps references to its callbacks and endpoint.
+    std::unique_ptr<BatchedUDPTransport> batched_udp_;
+    eprosima::uxr::CustomEndPoint agent_batched_udp_endpoint_;
+    std::unique_ptr<ShardedUDPAgent> agent_sharded_udp_;
+    std::unique_ptr<EpollTCPTransport> epoll_tcp_;
+    eprosima::uxr::CustomEndPoint agent_epoll_tcp_endpoint_;
+    std::unique_ptr<SharedMemoryAgentTransport> shared_memory_;
+    eprosima::uxr::CustomEndPoint agent_shared_memory_endpoint_;
+#endif
+#ifdef UXR_TEST_IO_URING
+    std::unique_ptr<IoUringTransport> io_uring_;
+    eprosima::uxr::CustomEndPoint agent_io_uring_endpoint_;
+#endif
     std::unique_ptr<eprosima::uxr::CustomAgent> agent_custom_;
     eprosima::uxr::CustomEndPoint agent_custom_endpoint_;
 
@@ -170,6 +315,16 @@ private:
     uint16_t port_;
 };
 
+#ifdef UXR_TEST_IO_URING
+// io_uring transports, none when the running kernel lacks the operations they use.
+inline std::vector<Transport> io_uring_transports()
+{
+    return IoUringTransport::is_supported()
+        ? std::vector<Transport>{Transport::IO_URING_UDP_TRANSPORT, Transport::IO_URING_TCP_TRANSPORT}
+        : std::vector<Transport>{};
+}
+#endif
+
 class ClientAgentInteraction : public ::testing::TestWithParam<std::tuple<Transport, MiddlewareKind>>
 {
 public:
@@ -194,6 +349,11 @@ public:
         {
             case Transport::UDP_IPV4_TRANSPORT:
             case Transport::TCP_IPV4_TRANSPORT:
+            case Transport::BATCHED_UDP_TRANSPORT:
+            case Transport::SHARDED_UDP_TRANSPORT:
+            case Transport::IO_URING_UDP_TRANSPORT:
+            case Transport::IO_URING_TCP_TRANSPORT:
+            case Transport::EPOLL_TCP_TRANSPORT:
             {
                 ASSERT_NO_FATAL_FAILURE(client_.init_transport(transport_, "127.0.0.1", std::to_string(AGENT_PORT).c_str()));
                 break;
@@ -210,6 +370,15 @@ public:
                 ASSERT_NO_FATAL_FAILURE(client_.init_transport(transport_, NULL, NULL));
                 break;
             }
+#ifdef __linux__
+            case Transport::SHARED_MEMORY_TRANSPORT:
+            {
+                ASSERT_NO_FATAL_FAILURE(client_.init_transport(transport_, shared_memory_segment_name(AGENT_PORT).c_str(), NULL));
+                break;
+            }
+#endif
+            default:
+                break;
         }
     }
 
@@ -15,6 +15,7 @@ TEST_P(ClientAgentSerial, PingFromClientToAgent)
             break;
 
         case Transport::MULTISERIAL_TRANSPORT:
+        case Transport::EPOLL_MULTISERIAL_TRANSPORT:
         {
             std::vector<std::thread> ping_thr;
             for (auto & element : clients_multiserial_)
@@ -39,6 +40,69 @@ TEST_P(ClientAgentSerial, PingFromClientToAgent)
     }
 }
 
+#ifdef __linux__
+// Ports plugged into a running epoll multi-serial Agent are served, unplugged ones release their slot.
+TEST(ClientAgentEpollSerial, HotPlugPorts)
+{
+    const Transport transport(Transport::EPOLL_MULTISERIAL_TRANSPORT);
+    AgentSerial agent(transport, MiddlewareKind::CED, 1);
+    agent.start();
+    ASSERT_TRUE(agent.wait_multiserial_open());
+    EpollSerialTransport* epoll_serial = agent.get_epoll_serial_transport();
+
+    int plugged = epoll_serial->add_port(agent.port_name);
+    ASSERT_NE(-1, plugged);
+    EXPECT_EQ(2u, epoll_serial->get_fds().size());
+    grantpt(plugged);
+    unlockpt(plugged);
+
+    ClientSerial client(0.0f, 8);
+    ASSERT_NO_FATAL_FAILURE(client.init_transport(transport, ptsname(plugged), NULL));
+    ASSERT_NO_FATAL_FAILURE(client.ping_agent(transport));
+    ASSERT_NO_FATAL_FAILURE(client.close_transport(transport));
+
+    ASSERT_TRUE(epoll_serial->remove_port(plugged));
+    EXPECT_EQ(1u, epoll_serial->get_fds().size());
+    agent.stop();
+}
+
+// One Agent multiplexing the ports of a data concentrator, every client with its own session.
+TEST(ClientAgentEpollSerial, ManyPorts)
+{
+    const Transport transport(Transport::EPOLL_MULTISERIAL_TRANSPORT);
+    const size_t ports = 128;
+    AgentSerial agent(transport, MiddlewareKind::CED, ports);
+    agent.start();
+    ASSERT_TRUE(agent.wait_multiserial_open());
+
+    std::vector<int> masterfd = agent.getfd_multi();
+    std::vector<std::unique_ptr<ClientSerial>> clients;
+    for (size_t i = 0; i < ports; i++)
+    {
+        grantpt(masterfd[i]);
+        unlockpt(masterfd[i]);
+        clients.emplace_back(new ClientSerial(0.0f, 8));
+        ASSERT_NO_FATAL_FAILURE(clients.back()->init_transport(transport, ptsname(masterfd[i]), NULL));
+    }
+
+    std::vector<std::thread> ping_thr;
+    for (auto & client : clients)
+    {
+        ping_thr.emplace_back(&ClientSerial::ping_agent, client.get(), transport);
+    }
+    for (auto & thr : ping_thr)
+    {
+        thr.join();
+    }
+
+    for (auto & client : clients)
+    {
+        ASSERT_NO_FATAL_FAILURE(client->close_transport(transport));
+    }
+    agent.stop();
+}
+#endif // __linux__
+
 #ifdef INSTANTIATE_TEST_SUITE_P
 #define GTEST_INSTANTIATE_TEST_MACRO(x, y, z) INSTANTIATE_TEST_SUITE_P(x, y, z)
 #else
@@ -50,4 +114,13 @@ GTEST_INSTANTIATE_TEST_MACRO(
     ClientAgentSerial,
     ::testing::Combine(
         ::testing::Values(Transport::SERIAL_TRANSPORT, Transport::MULTISERIAL_TRANSPORT),
-        ::testing::Values(MiddlewareKind::FASTDDS)));
\ No newline at end of file
+        ::testing::Values(MiddlewareKind::FASTDDS)));
+
+#ifdef __linux__
+GTEST_INSTANTIATE_TEST_MACRO(
+    EpollSerialTransports,
+    ClientAgentSerial,
+    ::testing::Combine(
+        ::testing::Values(Transport::EPOLL_MULTISERIAL_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED)));
+#endif // __linux__
@@ -5,17 +5,23 @@
 #include <uxr/agent/transport/serial/TermiosAgentLinux.hpp>
 #include <ClientSerial.hpp>
 #include <fcntl.h>
+#ifdef __linux__
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
+#include <Epoll_serial_transport.hpp>
+#endif
 
 class AgentSerial
 {
 public:
     const char * baudrate = "115200";
     const char * port_name = "/dev/ptmx";
-    const int client_number = 2;
+    const size_t client_number;
 
     AgentSerial(Transport transport,
-          MiddlewareKind middleware)
-        : transport_(transport)
+          MiddlewareKind middleware,
+          size_t clients = 2)
+        : client_number(clients)
+        , transport_(transport)
         , middleware_{}
     {
         switch (middleware)
@@ -58,6 +64,30 @@ public:
                 ASSERT_TRUE(agent_multiserial_->start());
                 break;
             }
+#ifdef __linux__
+            case Transport::EPOLL_MULTISERIAL_TRANSPORT:
+            {
+                struct termios attr = ClientSerial::init_termios(baudrate);
+                std::vector<std::string> devs(client_number, port_name);
+
+                EpollSerialTransport::add_members(agent_epoll_serial_endpoint_);
+                epoll_serial_.reset(new EpollSerialTransport(devs, attr));
+
+                agent_epoll_serial_.reset(new eprosima::uxr::CustomAgent(
+                    "epoll_serial_agent",
+                    &agent_epoll_serial_endpoint_,
+                    middleware_,
+                    false,
+                    epoll_serial_->open,
+                    epoll_serial_->close,
+                    epoll_serial_->write,
+                    epoll_serial_->read));
+                ASSERT_TRUE(agent_epoll_serial_->start());
+                break;
+            }
+#endif
+            default:
+                break;
         }
     }
 
@@ -75,6 +105,15 @@ public:
                 ASSERT_TRUE(agent_multiserial_->stop());
                 break;
             }
+#ifdef __linux__
+            case Transport::EPOLL_MULTISERIAL_TRANSPORT:
+            {
+                ASSERT_TRUE(agent_epoll_serial_->stop());
+                break;
+            }
+#endif
+            default:
+                break;
         }
     }
 
@@ -85,9 +124,22 @@ public:
 
     std::vector<int> getfd_multi()
     {
+#ifdef __linux__
+        if (Transport::EPOLL_MULTISERIAL_TRANSPORT == transport_)
+        {
+            return epoll_serial_->get_fds();
+        }
+#endif
         return agent_multiserial_->getfds();
     }
 
+#ifdef __linux__
+    EpollSerialTransport* get_epoll_serial_transport()
+    {
+        return epoll_serial_.get();
+    }
+#endif
+
     bool wait_multiserial_open()
     {
         while (getfd_multi().size() != client_number)
@@ -102,6 +154,11 @@ private:
     Transport transport_;
     std::unique_ptr<eprosima::uxr::TermiosAgent> agent_serial_;
     std::unique_ptr<eprosima::uxr::MultiTermiosAgent> agent_multiserial_;
+#ifdef __linux__
+    std::unique_ptr<EpollSerialTransport> epoll_serial_;
+    eprosima::uxr::CustomEndPoint agent_epoll_serial_endpoint_;
+    std::unique_ptr<eprosima::uxr::CustomAgent> agent_epoll_serial_;
+#endif
 
     eprosima::uxr::Middleware::Kind middleware_;
 };
@@ -141,6 +198,7 @@ public:
                 break;
             }
             case Transport::MULTISERIAL_TRANSPORT:
+            case Transport::EPOLL_MULTISERIAL_TRANSPORT:
             {
                 agent_.wait_multiserial_open();
                 std::vector<int> masterfd = agent_.getfd_multi();
@@ -167,6 +225,7 @@ public:
                 break;
             }
             case Transport::MULTISERIAL_TRANSPORT:
+            case Transport::EPOLL_MULTISERIAL_TRANSPORT:
             {
                 for (size_t i = 0; i < clients_multiserial_.size(); i++)
                 {
@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <Client.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ClientAgentInteraction.hpp"
+
+/*
+ * Tens of thousands of mostly idle TCP clients, as behind a NAT gateway, connected to the epoll
+ * Agent next to one active client. The CPU time of the process while they idle is compared with
+ * its CPU time with no idle connection, and the active session must still be served.
+ *
+ * Every connection takes two descriptors of the process, both ends, so their number is capped by RLIMIT_NOFILE.
+ * The CPU test is skipped when the limit does not allow IDLE_CONNECTIONS, the number opened is recorded as a property.
+ */
+class ClientAgentTcpLoad : public ::testing::Test
+{
+public:
+    const Transport transport = Transport::EPOLL_TCP_TRANSPORT;
+    const uint16_t AGENT_PORT = 2018 + uint16_t(Transport::EPOLL_TCP_TRANSPORT);
+    const size_t IDLE_CONNECTIONS = 20000;
+    const std::chrono::seconds IDLE_WINDOW{1};
+    const size_t IDLE_WINDOWS = 5;
+    const int CONNECTION_TIMEOUT = 30000;
+
+    // CPU time allowed to the idle connections, as a fraction of one core, on the medians of the windows.
+    const double IDLE_CPU_BUDGET = 0.05;
+
+    ClientAgentTcpLoad()
+        : client_(0.0f, 8)
+        , agent_(transport, MiddlewareKind::CED, AGENT_PORT)
+        , idle_connections_(0)
+        , descriptors_limit_(0)
+    {}
+
+    ~ClientAgentTcpLoad()
+    {}
+
+    void SetUp() override
+    {
+        struct rlimit limit;
+        getrlimit(RLIMIT_NOFILE, &limit);
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+        getrlimit(RLIMIT_NOFILE, &limit);
+        descriptors_limit_ = size_t(limit.rlim_cur);
+        size_t available = (256 < limit.rlim_cur) ? size_t(limit.rlim_cur - 256) / 2 : 0;
+        idle_connections_ = std::min(IDLE_CONNECTIONS, available);
+        RecordProperty("idle_connections", int(idle_connections_));
+
+        agent_.start();
+        ASSERT_NO_FATAL_FAILURE(client_.init_transport(transport, "127.0.0.1", std::to_string(AGENT_PORT).c_str()));
+    }
+
+    void TearDown() override
+    {
+        close_idle_connections();
+        ASSERT_NO_FATAL_FAILURE(client_.close_transport(transport));
+        agent_.stop();
+    }
+
+    void open_idle_connections()
+    {
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(AGENT_PORT);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        for (size_t i = 0; i < idle_connections_; ++i)
+        {
+            int fd = socket(AF_INET, SOCK_STREAM, 0);
+            ASSERT_NE(-1, fd) << "connection " << i;
+            idle_fds_.push_back(fd);
+            ASSERT_EQ(0, connect(fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address))) << "connection " << i;
+        }
+    }
+
+    void close_idle_connections()
+    {
+        // Reset instead of closing gracefully, so the ephemeral ports are not held in TIME_WAIT.
+        struct linger reset = {1, 0};
+        for (int fd : idle_fds_)
+        {
+            setsockopt(fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+            close(fd);
+        }
+        idle_fds_.clear();
+    }
+
+    bool wait_connections(size_t number, int timeout)
+    {
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+        while (agent_.get_epoll_tcp_transport()->get_connections() != number)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return true;
+    }
+
+    // CPU time of the process, the Agent threads included, while the test thread sleeps IDLE_WINDOW.
+    // Median of IDLE_WINDOWS windows, so a burst of load on the host does not decide the result.
+    int64_t idle_cpu_ns()
+    {
+        std::vector<int64_t> windows;
+        for (size_t i = 0; i < IDLE_WINDOWS; ++i)
+        {
+            int64_t begin = process_cpu_ns();
+            std::this_thread::sleep_for(IDLE_WINDOW);
+            windows.push_back(process_cpu_ns() - begin);
+        }
+        std::nth_element(windows.begin(), windows.begin() + windows.size() / 2, windows.end());
+        return windows[windows.size() / 2];
+    }
+
+    static int64_t process_cpu_ns()
+    {
+        struct timespec time;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time);
+        return int64_t(time.tv_sec) * 1000000000 + int64_t(time.tv_nsec);
+    }
+
+protected:
+    Client client_;
+    Agent agent_;
+    size_t idle_connections_;
+    size_t descriptors_limit_;
+    std::vector<int> idle_fds_;
+};
+
+TEST_F(ClientAgentTcpLoad, IdleConnectionsCostNoCpu)
+{
+    if (IDLE_CONNECTIONS > idle_connections_)
+    {
+        GTEST_SKIP() << "RLIMIT_NOFILE " << descriptors_limit_ << " allows " << idle_connections_
+                     << " idle connections out of " << IDLE_CONNECTIONS;
+    }
+
+    ASSERT_NO_FATAL_FAILURE(client_.create_entities_xml<MiddlewareKind::CED>(1, 0x80, UXR_STATUS_OK, 0));
+    int64_t baseline = idle_cpu_ns();
+
+    ASSERT_NO_FATAL_FAILURE(open_idle_connections());
+    ASSERT_TRUE(wait_connections(idle_connections_ + 1, CONNECTION_TIMEOUT));
+    int64_t loaded = idle_cpu_ns();
+
+    int64_t window = std::chrono::duration_cast<std::chrono::nanoseconds>(IDLE_WINDOW).count();
+    EXPECT_LT(loaded, baseline + int64_t(IDLE_CPU_BUDGET * double(window)))
+        << idle_connections_ << " idle connections, " << baseline << " ns without them";
+
+    ASSERT_NO_FATAL_FAILURE(client_.create_entities_xml<MiddlewareKind::CED>(2, 0x80, UXR_STATUS_OK, 0));
+}
+
+TEST_F(ClientAgentTcpLoad, ClosedConnectionsReleaseTheirSlots)
+{
+    ASSERT_NO_FATAL_FAILURE(open_idle_connections());
+    ASSERT_TRUE(wait_connections(idle_connections_ + 1, CONNECTION_TIMEOUT));
+
+    close_idle_connections();
+    ASSERT_TRUE(wait_connections(1, CONNECTION_TIMEOUT));
+
+    ASSERT_NO_FATAL_FAILURE(open_idle_connections());
+    ASSERT_TRUE(wait_connections(idle_connections_ + 1, CONNECTION_TIMEOUT));
+    ASSERT_NO_FATAL_FAILURE(client_.create_entities_xml<MiddlewareKind::CED>(1, 0x80, UXR_STATUS_OK, 0));
+}
@@ -0,0 +1,105 @@
+#include "AgentSerialization.hpp"
+#include "SerializationBenchmark.hpp"
+
+#include <uxr/agent/types/XRCETypes.hpp>
+#include <uxr/agent/message/InputMessage.hpp>
+#include <uxr/agent/message/OutputMessage.hpp>
+
+/*
+ * The Agent codec is measured through its message classes, as the Agent processes them:
+ * the deserialization parses the message header, the submessage header and the payload,
+ * and the serialization builds a whole message with a single submessage.
+ */
+template<typename T>
+static bool read_catalogue(std::vector<uint8_t>& bytes, dds::xrce::MessageHeader& header, T& payload)
+{
+    eprosima::uxr::InputMessage input(bytes.data(), bytes.size());
+    header = input.get_header();
+    return input.prepare_next_submessage() && input.get_payload(payload);
+}
+
+template<typename T>
+static void agent_serialize(benchmark::State& state, std::vector<uint8_t> (*catalogue)(), dds::xrce::SubmessageId submessage_id, T payload)
+{
+    std::vector<uint8_t> bytes = catalogue();
+    dds::xrce::MessageHeader header;
+    if (!read_catalogue(bytes, header, payload))
+    {
+        state.SkipWithError("catalogue payload does not deserialize");
+        return;
+    }
+
+    dds::xrce::SubmessageHeader subheader;
+    size_t message_size = header.getCdrSerializedSize() +
+                          subheader.getCdrSerializedSize() +
+                          payload.getCdrSerializedSize();
+    size_t length = 0;
+
+    for (auto _ : state)
+    {
+        eprosima::uxr::OutputMessage output(header, message_size);
+        output.append_submessage(submessage_id, payload, 0x0001);
+        length = output.get_len();
+        benchmark::DoNotOptimize(output.get_buf());
+        benchmark::ClobberMemory();
+    }
+
+    set_serialization_counters(state, length);
+}
+
+template<typename T>
+static void agent_deserialize(benchmark::State& state, std::vector<uint8_t> (*catalogue)(), T payload)
+{
+    std::vector<uint8_t> bytes = catalogue();
+    dds::xrce::MessageHeader header;
+    if (!read_catalogue(bytes, header, payload))
+    {
+        state.SkipWithError("catalogue payload does not deserialize");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        eprosima::uxr::InputMessage input(bytes.data(), bytes.size());
+        input.prepare_next_submessage();
+        input.get_payload(payload);
+        benchmark::DoNotOptimize(payload);
+        benchmark::ClobberMemory();
+    }
+
+    set_serialization_counters(state, bytes.size());
+}
+
+/* ######################################### CLIENT TO AGENT ################################################ */
+
+BENCHMARK_CAPTURE(agent_deserialize, CreateClientPayload,
+    &AgentSerialization::create_client_payload, dds::xrce::CREATE_CLIENT_Payload());
+BENCHMARK_CAPTURE(agent_deserialize, CreatePayload,
+    &AgentSerialization::create_payload, dds::xrce::CREATE_Payload());
+BENCHMARK_CAPTURE(agent_deserialize, GetInfoPayload,
+    &AgentSerialization::get_info_payload, dds::xrce::GET_INFO_Payload());
+BENCHMARK_CAPTURE(agent_deserialize, DeletePayload,
+    &AgentSerialization::delete_payload, dds::xrce::DELETE_Payload());
+BENCHMARK_CAPTURE(agent_deserialize, ReadDataPayload,
+    &AgentSerialization::read_data_payload, dds::xrce::READ_DATA_Payload());
+BENCHMARK_CAPTURE(agent_deserialize, WriteDataPayloadData,
+    &AgentSerialization::write_data_payload_data, dds::xrce::WRITE_DATA_Payload_Data());
+BENCHMARK_CAPTURE(agent_deserialize, AcknackPayload,
+    &AgentSerialization::acknack_payload, dds::xrce::ACKNACK_Payload());
+BENCHMARK_CAPTURE(agent_deserialize, HeartbeatPayload,
+    &AgentSerialization::heartbeat_payload, dds::xrce::HEARTBEAT_Payload());
+
+/* ######################################### AGENT TO CLIENT ################################################ */
+
+BENCHMARK_CAPTURE(agent_serialize, StatusAgentPayload,
+    &AgentSerialization::status_agent_payload, dds::xrce::STATUS_AGENT, dds::xrce::STATUS_AGENT_Payload());
+BENCHMARK_CAPTURE(agent_serialize, StatusPayload,
+    &AgentSerialization::status_payload, dds::xrce::STATUS, dds::xrce::STATUS_Payload());
+BENCHMARK_CAPTURE(agent_serialize, InfoPayload,
+    &AgentSerialization::info_payload, dds::xrce::INFO, dds::xrce::INFO_Payload());
+BENCHMARK_CAPTURE(agent_serialize, DataPayloadData,
+    &AgentSerialization::data_payload_data, dds::xrce::DATA, dds::xrce::DATA_Payload_Data());
+BENCHMARK_CAPTURE(agent_serialize, AcknackPayload,
+    &AgentSerialization::acknack_payload, dds::xrce::ACKNACK, dds::xrce::ACKNACK_Payload());
+BENCHMARK_CAPTURE(agent_serialize, HeartbeatPayload,
+    &AgentSerialization::heartbeat_payload, dds::xrce::HEARTBEAT, dds::xrce::HEARTBEAT_Payload());
@@ -0,0 +1,25 @@
+#ifndef IN_TEST_CLIENT_CROSS_PAYLOADS_HPP
+#define IN_TEST_CLIENT_CROSS_PAYLOADS_HPP
+
+#include <uxr/client/core/type/xrce_types.h>
+
+/*
+ * Payloads of the cross serialization catalogue, before serialization.
+ */
+struct ClientPayloads
+{
+    static CREATE_CLIENT_Payload create_client_payload();
+    static CREATE_Payload create_payload();
+    static GET_INFO_Payload get_info_payload();
+    static DELETE_Payload delete_payload();
+    static STATUS_AGENT_Payload status_agent_payload();
+    static STATUS_Payload status_payload();
+    static INFO_Payload info_payload();
+    static READ_DATA_Payload read_data_payload();
+    static WRITE_DATA_Payload_Data write_data_payload_data();
+    static BaseObjectRequest data_payload_data();
+    static ACKNACK_Payload acknack_payload();
+    static HEARTBEAT_Payload heartbeat_payload();
+};
+
+#endif //IN_TEST_CLIENT_CROSS_PAYLOADS_HPP
@@ -1,4 +1,5 @@
 #include "ClientSerialization.hpp"
+#include "ClientPayloads.hpp"
 
 // #include <core/serialization/xrce_protocol_internal.h>
 #include <uxr/client/core/type/xrce_types.h>
@@ -7,14 +8,8 @@
 
 #define BUFFER_LENGTH 1024
 
-std::vector<uint8_t> ClientSerialization::create_client_payload()
+CREATE_CLIENT_Payload ClientPayloads::create_client_payload()
 {
-    //change in a future by client_payload_sizeof function and remove resize
-    std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
-
-    ucdrBuffer ub;
-    ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
-
     CREATE_CLIENT_Payload payload;
     payload.client_representation.xrce_cookie = XrceCookie{0x89, 0xAB, 0xCD, 0xEF};
     payload.client_representation.xrce_version = XrceVersion{0x01, 0x23};
@@ -23,20 +18,28 @@ std::vector<uint8_t> ClientSerialization::create_client_payload()
     payload.client_representation.session_id = 0x01;
     payload.client_representation.optional_properties = 0x00;
     payload.client_representation.mtu = 0x2345;
-    uxr_serialize_CREATE_CLIENT_Payload(&ub, &payload);
 
-    buffer.resize(std::size_t(ub.iterator - ub.init));
-
-    return buffer;
+    return payload;
 }
 
-std::vector<uint8_t> ClientSerialization::create_payload()
+std::vector<uint8_t> ClientSerialization::create_client_payload()
 {
+    //change in a future by client_payload_sizeof function and remove resize
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
 
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
+    CREATE_CLIENT_Payload payload = ClientPayloads::create_client_payload();
+    uxr_serialize_CREATE_CLIENT_Payload(&ub, &payload);
+
+    buffer.resize(std::size_t(ub.iterator - ub.init));
+
+    return buffer;
+}
+
+CREATE_Payload ClientPayloads::create_payload()
+{
     CREATE_Payload payload;
     payload.base.request_id = RequestId{0x01, 0x23};
     payload.base.object_id = ObjectId{0x45, 0x67};
@@ -45,6 +48,17 @@ std::vector<uint8_t> ClientSerialization::create_payload()
     payload.object_representation._.participant.domain_id = int16_t(0x09AB);
     payload.object_representation._.participant.base.representation._.object_reference = const_cast<char*>("ABCDE");
 
+    return payload;
+}
+
+std::vector<uint8_t> ClientSerialization::create_payload()
+{
+    std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
+
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
+
+    CREATE_Payload payload = ClientPayloads::create_payload();
     uxr_serialize_CREATE_Payload(&ub, &payload);
 
     buffer.resize(std::size_t(ub.iterator - ub.init));
@@ -52,6 +66,16 @@ std::vector<uint8_t> ClientSerialization::create_payload()
     return buffer;
 }
 
+GET_INFO_Payload ClientPayloads::get_info_payload()
+{
+    GET_INFO_Payload payload;
+    payload.base.request_id = RequestId{0x01, 0x23};
+    payload.base.object_id = ObjectId{0x45, 0x67};
+    payload.info_mask = 0x89ABCDEF;
+
+    return payload;
+}
+
 std::vector<uint8_t> ClientSerialization::get_info_payload()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
@@ -59,10 +83,7 @@ std::vector<uint8_t> ClientSerialization::get_info_payload()
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
-    GET_INFO_Payload payload;
-    payload.base.request_id = RequestId{0x01, 0x23};
-    payload.base.object_id = ObjectId{0x45, 0x67};
-    payload.info_mask = 0x89ABCDEF;
+    GET_INFO_Payload payload = ClientPayloads::get_info_payload();
     uxr_serialize_GET_INFO_Payload(&ub, &payload);
 
     buffer.resize(std::size_t(ub.iterator - ub.init));
@@ -70,6 +91,15 @@ std::vector<uint8_t> ClientSerialization::get_info_payload()
     return buffer;
 }
 
+DELETE_Payload ClientPayloads::delete_payload()
+{
+    DELETE_Payload payload;
+    payload.base.request_id = RequestId{0x01, 0x23};
+    payload.base.object_id = ObjectId{0x45, 0x67};
+
+    return payload;
+}
+
 std::vector<uint8_t> ClientSerialization::delete_payload()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
@@ -77,9 +107,7 @@ std::vector<uint8_t> ClientSerialization::delete_payload()
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
-    DELETE_Payload payload;
-    payload.base.request_id = RequestId{0x01, 0x23};
-    payload.base.object_id = ObjectId{0x45, 0x67};
+    DELETE_Payload payload = ClientPayloads::delete_payload();
     uxr_serialize_DELETE_Payload(&ub, &payload);
 
     buffer.resize(std::size_t(ub.iterator - ub.init));
@@ -87,13 +115,8 @@ std::vector<uint8_t> ClientSerialization::delete_payload()
     return buffer;
 }
 
-std::vector<uint8_t> ClientSerialization::status_agent_payload()
+STATUS_AGENT_Payload ClientPayloads::status_agent_payload()
 {
-    std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
-
-    ucdrBuffer ub;
-    ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
-
     STATUS_AGENT_Payload payload;
     payload.result.status = 0x01;
     payload.result.implementation_status = 0x23;
@@ -102,39 +125,52 @@ std::vector<uint8_t> ClientSerialization::status_agent_payload()
     payload.agent_info.xrce_vendor_id = XrceVendorId{0x45, 0x67};
     payload.agent_info.optional_properties = 0x00;
 
-    uxr_serialize_STATUS_AGENT_Payload(&ub, &payload);
-
-    buffer.resize(std::size_t(ub.iterator - ub.init));
-
-    return buffer;
+    return payload;
 }
 
-std::vector<uint8_t> ClientSerialization::status_payload()
+std::vector<uint8_t> ClientSerialization::status_agent_payload()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
 
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
+    STATUS_AGENT_Payload payload = ClientPayloads::status_agent_payload();
+    uxr_serialize_STATUS_AGENT_Payload(&ub, &payload);
+
+    buffer.resize(std::size_t(ub.iterator - ub.init));
+
+    return buffer;
+}
+
+STATUS_Payload ClientPayloads::status_payload()
+{
     STATUS_Payload payload;
     payload.base.related_request.request_id = RequestId{0x01, 0x23};
     payload.base.related_request.object_id = ObjectId{0x45, 0x67};
     payload.base.result.implementation_status = 0x89;
     payload.base.result.status = 0xAB;
-    uxr_serialize_STATUS_Payload(&ub, &payload);
-
-    buffer.resize(std::size_t(ub.iterator - ub.init));
 
-    return buffer;
+    return payload;
 }
 
-std::vector<uint8_t> ClientSerialization::info_payload()
+std::vector<uint8_t> ClientSerialization::status_payload()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
 
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
+    STATUS_Payload payload = ClientPayloads::status_payload();
+    uxr_serialize_STATUS_Payload(&ub, &payload);
+
+    buffer.resize(std::size_t(ub.iterator - ub.init));
+
+    return buffer;
+}
+
+INFO_Payload ClientPayloads::info_payload()
+{
     INFO_Payload payload;
     payload.base.related_request.request_id = RequestId{0x01, 0x23};
     payload.base.related_request.object_id = ObjectId{0x45, 0x67};
@@ -157,20 +193,26 @@ std::vector<uint8_t> ClientSerialization::info_payload()
     payload.object_info.activity._.agent.address_seq.data[0]._.medium_locator.address[2] = 0x45;
     payload.object_info.activity._.agent.address_seq.data[0]._.medium_locator.address[3] = 0x67;
 
-    uxr_serialize_INFO_Payload(&ub, &payload);
-
-    buffer.resize(std::size_t(ub.iterator - ub.init));
-
-    return buffer;
+    return payload;
 }
 
-std::vector<uint8_t> ClientSerialization::read_data_payload()
+std::vector<uint8_t> ClientSerialization::info_payload()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
 
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
+    INFO_Payload payload = ClientPayloads::info_payload();
+    uxr_serialize_INFO_Payload(&ub, &payload);
+
+    buffer.resize(std::size_t(ub.iterator - ub.init));
+
+    return buffer;
+}
+
+READ_DATA_Payload ClientPayloads::read_data_payload()
+{
     READ_DATA_Payload payload;
     payload.base.request_id = RequestId{0x01, 0x23};
     payload.base.object_id = ObjectId{0x45, 0x67};
@@ -184,6 +226,17 @@ std::vector<uint8_t> ClientSerialization::read_data_payload()
     payload.read_specification.delivery_control.min_pace_period = 0xEF01;
     payload.read_specification.content_filter_expression = const_cast<char*>("ABCDE");
 
+    return payload;
+}
+
+std::vector<uint8_t> ClientSerialization::read_data_payload()
+{
+    std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
+
+    ucdrBuffer ub;
+    ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
+
+    READ_DATA_Payload payload = ClientPayloads::read_data_payload();
     uxr_serialize_READ_DATA_Payload(&ub, &payload);
 
     buffer.resize(std::size_t(ub.iterator - ub.init));
@@ -191,6 +244,15 @@ std::vector<uint8_t> ClientSerialization::read_data_payload()
     return buffer;
 }
 
+WRITE_DATA_Payload_Data ClientPayloads::write_data_payload_data()
+{
+    WRITE_DATA_Payload_Data payload;
+    payload.base.request_id = RequestId{0x01, 0x23};
+    payload.base.object_id = ObjectId{0x45, 0x67};
+
+    return payload;
+}
+
 std::vector<uint8_t> ClientSerialization::write_data_payload_data()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
@@ -198,10 +260,7 @@ std::vector<uint8_t> ClientSerialization::write_data_payload_data()
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
-    WRITE_DATA_Payload_Data payload;
-    payload.base.request_id = RequestId{0x01, 0x23};
-    payload.base.object_id = ObjectId{0x45, 0x67};
-
+    WRITE_DATA_Payload_Data payload = ClientPayloads::write_data_payload_data();
     uxr_serialize_WRITE_DATA_Payload_Data(&ub, &payload);
     ucdr_serialize_array_char(&ub, "BYTES", 5);
 
@@ -234,6 +293,15 @@ std::vector<uint8_t> ClientSerialization::write_data_payload_packed_samples()
     return std::vector<uint8_t>();
 }
 
+BaseObjectRequest ClientPayloads::data_payload_data()
+{
+    BaseObjectRequest base;
+    base.request_id = RequestId{0x01, 0x23};
+    base.object_id = ObjectId{0x45, 0x67};
+
+    return base;
+}
+
 std::vector<uint8_t> ClientSerialization::data_payload_data()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
@@ -241,10 +309,7 @@ std::vector<uint8_t> ClientSerialization::data_payload_data()
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
-    BaseObjectRequest base;
-    base.request_id = RequestId{0x01, 0x23};
-    base.object_id = ObjectId{0x45, 0x67};
-
+    BaseObjectRequest base = ClientPayloads::data_payload_data();
     uxr_serialize_BaseObjectRequest(&ub, &base);
     ucdr_serialize_array_char(&ub, "BYTES", 5);
 
@@ -277,6 +342,17 @@ std::vector<uint8_t> ClientSerialization::data_payload_packed_samples()
     return std::vector<uint8_t>();
 }
 
+ACKNACK_Payload ClientPayloads::acknack_payload()
+{
+    ACKNACK_Payload payload;
+    payload.first_unacked_seq_num = uint16_t(0x0123);
+    payload.nack_bitmap[0] = uint8_t(0x45);
+    payload.nack_bitmap[1] = uint8_t(0x67);
+    payload.stream_id = uint8_t(0x89);
+
+    return payload;
+}
+
 std::vector<uint8_t> ClientSerialization::acknack_payload()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
@@ -284,11 +360,7 @@ std::vector<uint8_t> ClientSerialization::acknack_payload()
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
-    ACKNACK_Payload payload;
-    payload.first_unacked_seq_num = uint16_t(0x0123);
-    payload.nack_bitmap[0] = uint8_t(0x45);
-    payload.nack_bitmap[1] = uint8_t(0x67);
-    payload.stream_id = uint8_t(0x89);
+    ACKNACK_Payload payload = ClientPayloads::acknack_payload();
     uxr_serialize_ACKNACK_Payload(&ub, &payload);
 
     buffer.resize(std::size_t(ub.iterator - ub.init));
@@ -296,6 +368,16 @@ std::vector<uint8_t> ClientSerialization::acknack_payload()
     return buffer;
 }
 
+HEARTBEAT_Payload ClientPayloads::heartbeat_payload()
+{
+    HEARTBEAT_Payload payload;
+    payload.first_unacked_seq_nr = uint16_t(0x0123);
+    payload.last_unacked_seq_nr = uint16_t(0x4567);
+    payload.stream_id = uint8_t(0x89);
+
+    return payload;
+}
+
 std::vector<uint8_t> ClientSerialization::heartbeat_payload()
 {
     std::vector<uint8_t> buffer(BUFFER_LENGTH, 0x00);
@@ -303,14 +385,10 @@ std::vector<uint8_t> ClientSerialization::heartbeat_payload()
     ucdrBuffer ub;
     ucdr_init_buffer(&ub, &buffer.front(), uint32_t(buffer.capacity()));
 
-    HEARTBEAT_Payload payload;
-    payload.first_unacked_seq_nr = uint16_t(0x0123);
-    payload.last_unacked_seq_nr = uint16_t(0x4567);
-    payload.stream_id = uint8_t(0x89);
+    HEARTBEAT_Payload payload = ClientPayloads::heartbeat_payload();
     uxr_serialize_HEARTBEAT_Payload(&ub, &payload);
 
     buffer.resize(std::size_t(ub.iterator - ub.init));
 
     return buffer;
 }
-
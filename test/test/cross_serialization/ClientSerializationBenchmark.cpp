@@ -0,0 +1,87 @@
+#include "ClientSerialization.hpp"
+#include "ClientPayloads.hpp"
+#include "SerializationBenchmark.hpp"
+
+#include <ucdr/microcdr.h>
+
+#define BUFFER_LENGTH 1024
+
+template<typename T>
+static void client_serialize(benchmark::State& state, T (*build)(), bool (*serialize)(ucdrBuffer*, const T*))
+{
+    T payload = build();
+    uint8_t buffer[BUFFER_LENGTH];
+    size_t length = 0;
+
+    for (auto _ : state)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, buffer, BUFFER_LENGTH);
+        serialize(&ub, &payload);
+        length = ucdr_buffer_length(&ub);
+        benchmark::DoNotOptimize(buffer);
+        benchmark::ClobberMemory();
+    }
+
+    set_serialization_counters(state, length);
+}
+
+template<typename T>
+static void client_deserialize(benchmark::State& state, std::vector<uint8_t> (*catalogue)(), bool (*deserialize)(ucdrBuffer*, T*))
+{
+    std::vector<uint8_t> bytes = catalogue();
+    T payload;
+
+    ucdrBuffer check;
+    ucdr_init_buffer(&check, bytes.data(), bytes.size());
+    if (!deserialize(&check, &payload))
+    {
+        state.SkipWithError("catalogue payload does not deserialize");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        ucdrBuffer ub;
+        ucdr_init_buffer(&ub, bytes.data(), bytes.size());
+        deserialize(&ub, &payload);
+        benchmark::DoNotOptimize(payload);
+        benchmark::ClobberMemory();
+    }
+
+    set_serialization_counters(state, bytes.size());
+}
+
+/* ######################################### CLIENT TO AGENT ################################################ */
+
+BENCHMARK_CAPTURE(client_serialize, CreateClientPayload,
+    &ClientPayloads::create_client_payload, &uxr_serialize_CREATE_CLIENT_Payload);
+BENCHMARK_CAPTURE(client_serialize, CreatePayload,
+    &ClientPayloads::create_payload, &uxr_serialize_CREATE_Payload);
+BENCHMARK_CAPTURE(client_serialize, GetInfoPayload,
+    &ClientPayloads::get_info_payload, &uxr_serialize_GET_INFO_Payload);
+BENCHMARK_CAPTURE(client_serialize, DeletePayload,
+    &ClientPayloads::delete_payload, &uxr_serialize_DELETE_Payload);
+BENCHMARK_CAPTURE(client_serialize, ReadDataPayload,
+    &ClientPayloads::read_data_payload, &uxr_serialize_READ_DATA_Payload);
+BENCHMARK_CAPTURE(client_serialize, WriteDataPayloadData,
+    &ClientPayloads::write_data_payload_data, &uxr_serialize_WRITE_DATA_Payload_Data);
+BENCHMARK_CAPTURE(client_serialize, AcknackPayload,
+    &ClientPayloads::acknack_payload, &uxr_serialize_ACKNACK_Payload);
+BENCHMARK_CAPTURE(client_serialize, HeartbeatPayload,
+    &ClientPayloads::heartbeat_payload, &uxr_serialize_HEARTBEAT_Payload);
+
+/* ######################################### AGENT TO CLIENT ################################################ */
+
+BENCHMARK_CAPTURE(client_deserialize, StatusAgentPayload,
+    &ClientSerialization::status_agent_payload, &uxr_deserialize_STATUS_AGENT_Payload);
+BENCHMARK_CAPTURE(client_deserialize, StatusPayload,
+    &ClientSerialization::status_payload, &uxr_deserialize_STATUS_Payload);
+BENCHMARK_CAPTURE(client_deserialize, InfoPayload,
+    &ClientSerialization::info_payload, &uxr_deserialize_INFO_Payload);
+BENCHMARK_CAPTURE(client_deserialize, DataPayloadData,
+    &ClientSerialization::data_payload_data, &uxr_deserialize_BaseObjectRequest);
+BENCHMARK_CAPTURE(client_deserialize, AcknackPayload,
+    &ClientSerialization::acknack_payload, &uxr_deserialize_ACKNACK_Payload);
+BENCHMARK_CAPTURE(client_deserialize, HeartbeatPayload,
+    &ClientSerialization::heartbeat_payload, &uxr_deserialize_HEARTBEAT_Payload);
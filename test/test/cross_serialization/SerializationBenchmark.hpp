@@ -0,0 +1,17 @@
+#ifndef IN_TEST_SERIALIZATION_BENCHMARK_HPP
+#define IN_TEST_SERIALIZATION_BENCHMARK_HPP
+
+#include <benchmark/benchmark.h>
+
+/*
+ * Besides the time per operation, every benchmark reports the payload length and the bytes processed per nanosecond.
+ */
+inline void set_serialization_counters(benchmark::State& state, size_t length)
+{
+    double bytes = double(state.iterations()) * double(length);
+    state.SetBytesProcessed(int64_t(bytes));
+    state.counters["bytes"] = double(length);
+    state.counters["bytes_per_ns"] = benchmark::Counter(bytes / 1e9, benchmark::Counter::kIsRate);
+}
+
+#endif //IN_TEST_SERIALIZATION_BENCHMARK_HPP
@@ -0,0 +1,344 @@
+#include "Batched_can_transport.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Largest message in a frame, the first data byte holds its length.
+static const size_t MAX_MESSAGE_SIZE = CANFD_MAX_DLEN - 1;
+
+// Data length of the frame carrying length bytes, padded to the next one a DLC encodes.
+static uint8_t frame_length(size_t length)
+{
+    static const uint8_t dlc_lengths[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 12, 16, 20, 24, 32, 48, 64};
+
+    for (uint8_t dlc_length : dlc_lengths)
+    {
+        if (length <= dlc_length)
+        {
+            return dlc_length;
+        }
+    }
+    return CANFD_MAX_DLEN;
+}
+
+BatchedCanTransport::BatchedCanTransport(
+        const std::string& device,
+        uint32_t can_id,
+        size_t batch_size,
+        std::chrono::microseconds flush_deadline)
+    : device_(device)
+    , can_id_(can_id & CAN_EFF_MASK)
+    , batch_size_(std::max(batch_size, size_t(1)))
+    , flush_deadline_(flush_deadline)
+    , fd_(-1)
+    , event_fd_(-1)
+    , recv_batch_(batch_size_)
+    , recv_iovecs_(batch_size_)
+    , recv_msgs_(batch_size_)
+    , received_(0)
+    , next_(0)
+    , send_batch_(batch_size_)
+    , send_iovecs_(batch_size_)
+    , send_msgs_(batch_size_)
+    , pending_(0)
+    , recv_calls_(0)
+    , recv_frames_(0)
+    , send_calls_(0)
+    , send_frames_(0)
+{
+    open = [this]() -> bool
+    {
+        return open_socket();
+    };
+
+    close = [this]() -> bool
+    {
+        return close_socket();
+    };
+
+    write = [this](
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return send(destination_endpoint, buffer, message_length, transport_rc);
+    };
+
+    read = [this](
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return recv(source_endpoint, buffer, buffer_length, timeout, transport_rc);
+    };
+}
+
+BatchedCanTransport::~BatchedCanTransport()
+{
+    close_socket();
+}
+
+void BatchedCanTransport::add_members(eprosima::uxr::CustomEndPoint& endpoint)
+{
+    try
+    {
+        endpoint.add_member<uint32_t>("can_id");
+    }
+    catch(const std::exception& /*e*/)
+    {
+        // Already added by a previous Agent.
+    }
+}
+
+BatchedCanTransport::Stats BatchedCanTransport::get_stats() const
+{
+    Stats stats;
+    stats.recv_calls = recv_calls_;
+    stats.recv_frames = recv_frames_;
+    stats.send_calls = send_calls_;
+    stats.send_frames = send_frames_;
+    return stats;
+}
+
+bool BatchedCanTransport::open_socket()
+{
+    unsigned int interface_index = if_nametoindex(device_.c_str());
+    if (0 == interface_index)
+    {
+        return false;
+    }
+
+    fd_ = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (-1 == fd_)
+    {
+        return false;
+    }
+
+    // CAN FD frames, extended data frames only.
+    int enable_canfd = 1;
+    struct can_filter filter = {CAN_EFF_FLAG, CAN_EFF_FLAG | CAN_RTR_FLAG};
+    struct sockaddr_can address = {};
+    address.can_family = AF_CAN;
+    address.can_ifindex = int(interface_index);
+    if (-1 == setsockopt(fd_, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable_canfd, sizeof(enable_canfd))
+        || -1 == setsockopt(fd_, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter))
+        || -1 == bind(fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)))
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK);
+    if (-1 == event_fd_)
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    // Frames are read and written in place, the iovecs never change.
+    for (size_t i = 0; i < batch_size_; ++i)
+    {
+        recv_iovecs_[i].iov_base = &recv_batch_[i];
+        recv_iovecs_[i].iov_len = sizeof(struct canfd_frame);
+        recv_msgs_[i].msg_hdr = {};
+        recv_msgs_[i].msg_hdr.msg_iov = &recv_iovecs_[i];
+        recv_msgs_[i].msg_hdr.msg_iovlen = 1;
+
+        send_iovecs_[i].iov_base = &send_batch_[i];
+        send_iovecs_[i].iov_len = sizeof(struct canfd_frame);
+        send_msgs_[i].msg_hdr = {};
+        send_msgs_[i].msg_hdr.msg_iov = &send_iovecs_[i];
+        send_msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+    received_ = 0;
+    next_ = 0;
+    pending_ = 0;
+
+    return true;
+}
+
+bool BatchedCanTransport::close_socket()
+{
+    std::lock_guard<std::mutex> lock(send_mtx_);
+    if (-1 == fd_)
+    {
+        return true;
+    }
+
+    flush();
+    bool closed = (0 == ::close(fd_));
+    closed = (0 == ::close(event_fd_)) && closed;
+    fd_ = -1;
+    event_fd_ = -1;
+    return closed;
+}
+
+ssize_t BatchedCanTransport::recv(
+        eprosima::uxr::CustomEndPoint* source_endpoint,
+        uint8_t* buffer,
+        size_t buffer_length,
+        int timeout,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeout);
+
+    for (;;)
+    {
+        while (next_ == received_)
+        {
+            Clock::time_point wake = deadline;
+            {
+                std::lock_guard<std::mutex> lock(send_mtx_);
+                if (0 < pending_)
+                {
+                    if (flush_time_ <= Clock::now())
+                    {
+                        flush();
+                    }
+                    else
+                    {
+                        wake = std::min(wake, flush_time_);
+                    }
+                }
+            }
+
+            Clock::time_point now = Clock::now();
+            if (now >= deadline)
+            {
+                transport_rc = eprosima::uxr::TransportRc::timeout_error;
+                return 0;
+            }
+
+            int64_t wait = (wake > now) ? std::chrono::duration_cast<std::chrono::nanoseconds>(wake - now).count() : 0;
+            struct timespec wait_time = {time_t(wait / 1000000000), long(wait % 1000000000)};
+            struct pollfd fds[2] = {{fd_, POLLIN, 0}, {event_fd_, POLLIN, 0}};
+            int poll_rv = ppoll(fds, 2, &wait_time, nullptr);
+            if (-1 == poll_rv)
+            {
+                if (EINTR == errno)
+                {
+                    continue;
+                }
+                transport_rc = eprosima::uxr::TransportRc::server_error;
+                return 0;
+            }
+
+            if (0 != (fds[1].revents & POLLIN))
+            {
+                // A frame was queued for sending, its deadline is taken at the next iteration.
+                uint64_t events;
+                ssize_t drained = ::read(event_fd_, &events, sizeof(events));
+                (void) drained;
+            }
+
+            if (0 != (fds[0].revents & POLLIN))
+            {
+                int count = recvmmsg(fd_, recv_msgs_.data(), unsigned(batch_size_), MSG_DONTWAIT, nullptr);
+                ++recv_calls_;
+                if (0 < count)
+                {
+                    received_ = size_t(count);
+                    next_ = 0;
+                    recv_frames_ += uint64_t(count);
+                }
+            }
+        }
+
+        // Classic frames share the layout of CAN FD ones up to their 8 data bytes.
+        size_t index = next_++;
+        const struct canfd_frame& frame = recv_batch_[index];
+        size_t frame_size = recv_msgs_[index].msg_len;
+        uint32_t can_id = frame.can_id & CAN_EFF_MASK;
+        size_t length = frame.data[0];
+        if ((CAN_MTU != frame_size && CANFD_MTU != frame_size)
+            || can_id_ == can_id || size_t(frame.len) < length + 1)
+        {
+            continue;
+        }
+
+        if (buffer_length < length)
+        {
+            transport_rc = eprosima::uxr::TransportRc::server_error;
+            return 0;
+        }
+
+        std::memcpy(buffer, &frame.data[1], length);
+        source_endpoint->set_member_value<uint32_t>("can_id", can_id);
+        return static_cast<ssize_t>(length);
+    }
+}
+
+ssize_t BatchedCanTransport::send(
+        const eprosima::uxr::CustomEndPoint* destination_endpoint,
+        uint8_t* buffer,
+        size_t message_length,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    if (MAX_MESSAGE_SIZE < message_length)
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(send_mtx_);
+
+    // The frame is built in its batch slot, padding zeroed.
+    struct canfd_frame& frame = send_batch_[pending_++];
+    uint8_t length = frame_length(message_length + 1);
+    frame.can_id = (destination_endpoint->get_member<uint32_t>("can_id") & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    frame.len = length;
+    frame.flags = 0;
+    frame.data[0] = uint8_t(message_length);
+    std::memcpy(&frame.data[1], buffer, message_length);
+    std::memset(&frame.data[1 + message_length], 0, length - 1 - message_length);
+
+    if (batch_size_ == pending_ || 0 == flush_deadline_.count())
+    {
+        flush();
+    }
+    else if (1 == pending_)
+    {
+        // Wake up the receiver thread, which flushes the batch on the deadline.
+        flush_time_ = Clock::now() + flush_deadline_;
+        uint64_t event = 1;
+        ssize_t signaled = ::write(event_fd_, &event, sizeof(event));
+        (void) signaled;
+    }
+
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    return static_cast<ssize_t>(message_length);
+}
+
+void BatchedCanTransport::flush()
+{
+    size_t sent = 0;
+    while (sent < pending_)
+    {
+        int count = sendmmsg(fd_, &send_msgs_[sent], unsigned(pending_ - sent), 0);
+        ++send_calls_;
+        if (0 < count)
+        {
+            sent += size_t(count);
+            send_frames_ += uint64_t(count);
+        }
+        else if (EINTR != errno)
+        {
+            // The frame at the head is dropped, as a failed write would.
+            ++sent;
+        }
+    }
+    pending_ = 0;
+}
@@ -0,0 +1,106 @@
+#ifndef IN_TEST_BATCHED_CAN_TRANSPORT_HPP
+#define IN_TEST_BATCHED_CAN_TRANSPORT_HPP
+
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <linux/can.h>
+#include <sys/socket.h>
+
+/*
+ * CAN FD transport for the CustomAgent moving up to batch_size frames per syscall (Linux only).
+ *
+ * - Receive: recvmmsg drains the socket into an array of frames. Messages are handed to the Agent
+ *   one per call straight from their frame, so a frame costs no allocation.
+ * - Send: messages are framed in place in the send batch and flushed with sendmmsg when the batch
+ *   is full or when the oldest one has waited flush_deadline. A zero deadline flushes every frame right away.
+ *
+ * One XRCE message per frame, as the client CAN transport writes them: extended CAN ID of the client,
+ * message length in the first data byte and the message after it, padded to a length a DLC encodes.
+ * Clients are identified by their CAN ID, frames carrying the CAN ID of the Agent are not taken as input.
+ */
+class BatchedCanTransport
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats
+    {
+        uint64_t recv_calls;
+        uint64_t recv_frames;
+        uint64_t send_calls;
+        uint64_t send_frames;
+    };
+
+    BatchedCanTransport(
+            const std::string& device,
+            uint32_t can_id,
+            size_t batch_size = 32,
+            std::chrono::microseconds flush_deadline = std::chrono::microseconds(200));
+
+    ~BatchedCanTransport();
+
+    // Member identifying a client on the CustomEndPoint: its CAN ID.
+    static void add_members(eprosima::uxr::CustomEndPoint& endpoint);
+
+    Stats get_stats() const;
+
+    eprosima::uxr::CustomAgent::InitFunction open;
+    eprosima::uxr::CustomAgent::FiniFunction close;
+    eprosima::uxr::CustomAgent::SendMsgFunction write;
+    eprosima::uxr::CustomAgent::RecvMsgFunction read;
+
+private:
+    bool open_socket();
+    bool close_socket();
+
+    ssize_t recv(
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    ssize_t send(
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    // Sends the queued frames, send_mtx_ must be held.
+    void flush();
+
+    std::string device_;
+    uint32_t can_id_;
+    size_t batch_size_;
+    std::chrono::microseconds flush_deadline_;
+    int fd_;
+    int event_fd_;
+
+    // Receive batch, only used by the Agent receiver thread.
+    std::vector<struct canfd_frame> recv_batch_;
+    std::vector<struct iovec> recv_iovecs_;
+    std::vector<struct mmsghdr> recv_msgs_;
+    size_t received_;
+    size_t next_;
+
+    // Send batch, shared with the receiver thread for the deadline flush.
+    std::mutex send_mtx_;
+    std::vector<struct canfd_frame> send_batch_;
+    std::vector<struct iovec> send_iovecs_;
+    std::vector<struct mmsghdr> send_msgs_;
+    size_t pending_;
+    Clock::time_point flush_time_;
+
+    std::atomic<uint64_t> recv_calls_;
+    std::atomic<uint64_t> recv_frames_;
+    std::atomic<uint64_t> send_calls_;
+    std::atomic<uint64_t> send_frames_;
+};
+
+#endif //IN_TEST_BATCHED_CAN_TRANSPORT_HPP
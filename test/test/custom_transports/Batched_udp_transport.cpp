@@ -0,0 +1,421 @@
+#include "Batched_udp_transport.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <linux/filter.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Largest UDP payload.
+static const size_t DATAGRAM_SIZE = 65535;
+
+static void address_to_endpoint(const struct sockaddr_in6& address, eprosima::uxr::CustomEndPoint* endpoint)
+{
+    uint64_t high;
+    uint64_t low;
+    std::memcpy(&high, &address.sin6_addr.s6_addr[0], sizeof(high));
+    std::memcpy(&low, &address.sin6_addr.s6_addr[8], sizeof(low));
+    endpoint->set_member_value<uint64_t>("address_high", high);
+    endpoint->set_member_value<uint64_t>("address_low", low);
+    endpoint->set_member_value<uint16_t>("port", ntohs(address.sin6_port));
+}
+
+/*
+ * Classic BPF program selecting the socket of a SO_REUSEPORT group, run on the UDP payload.
+ * Message header: session_id (1), stream_id (1), sequence number (2) and, for session ids
+ * below 0x80, the client key (4). An index out of the group falls back to the kernel hash.
+ */
+static bool attach_client_key_steering(int fd, uint32_t group)
+{
+    struct sock_filter code[] = {
+        BPF_STMT(BPF_LD | BPF_B | BPF_ABS, 0),
+        BPF_JUMP(BPF_JMP | BPF_JGE | BPF_K, 0x80, 3, 0),
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, 4),
+        BPF_STMT(BPF_ALU | BPF_MOD | BPF_K, group),
+        BPF_STMT(BPF_RET | BPF_A, 0),
+        BPF_STMT(BPF_RET | BPF_K, group),
+    };
+    struct sock_fprog program = {static_cast<unsigned short>(sizeof(code) / sizeof(code[0])), code};
+    return 0 == setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program));
+}
+
+static void endpoint_to_address(const eprosima::uxr::CustomEndPoint* endpoint, struct sockaddr_in6& address)
+{
+    uint64_t high = endpoint->get_member<uint64_t>("address_high");
+    uint64_t low = endpoint->get_member<uint64_t>("address_low");
+    address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_port = htons(endpoint->get_member<uint16_t>("port"));
+    std::memcpy(&address.sin6_addr.s6_addr[0], &high, sizeof(high));
+    std::memcpy(&address.sin6_addr.s6_addr[8], &low, sizeof(low));
+}
+
+BatchedUDPTransport::BatchedUDPTransport(
+        uint16_t port,
+        size_t batch_size,
+        std::chrono::microseconds flush_deadline,
+        size_t reuse_port_group)
+    : port_(port)
+    , batch_size_(std::max(batch_size, size_t(1)))
+    , flush_deadline_(flush_deadline)
+    , reuse_port_group_(reuse_port_group)
+    , fd_(-1)
+    , event_fd_(-1)
+    , recv_buffers_(batch_size_, std::vector<uint8_t>(DATAGRAM_SIZE))
+    , recv_addresses_(batch_size_)
+    , recv_iovecs_(batch_size_)
+    , recv_msgs_(batch_size_)
+    , received_(0)
+    , next_(0)
+    , send_buffers_(batch_size_)
+    , send_addresses_(batch_size_)
+    , send_iovecs_(batch_size_)
+    , send_msgs_(batch_size_)
+    , pending_(0)
+    , recv_calls_(0)
+    , recv_datagrams_(0)
+    , send_calls_(0)
+    , send_datagrams_(0)
+{
+    open = [this]() -> bool
+    {
+        return open_socket();
+    };
+
+    close = [this]() -> bool
+    {
+        return close_socket();
+    };
+
+    write = [this](
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return send(destination_endpoint, buffer, message_length, transport_rc);
+    };
+
+    read = [this](
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return recv(source_endpoint, buffer, buffer_length, timeout, transport_rc);
+    };
+
+    writev = [this](
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            const custom_transport_slice* slices,
+            size_t slice_count,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return sendv(destination_endpoint, slices, slice_count, transport_rc);
+    };
+}
+
+BatchedUDPTransport::~BatchedUDPTransport()
+{
+    close_socket();
+}
+
+void BatchedUDPTransport::add_members(eprosima::uxr::CustomEndPoint& endpoint)
+{
+    try
+    {
+        endpoint.add_member<uint64_t>("address_high");
+        endpoint.add_member<uint64_t>("address_low");
+        endpoint.add_member<uint16_t>("port");
+    }
+    catch(const std::exception& /*e*/)
+    {
+        // Already added by a previous Agent.
+    }
+}
+
+BatchedUDPTransport::Stats BatchedUDPTransport::get_stats() const
+{
+    Stats stats;
+    stats.recv_calls = recv_calls_;
+    stats.recv_datagrams = recv_datagrams_;
+    stats.send_calls = send_calls_;
+    stats.send_datagrams = send_datagrams_;
+    return stats;
+}
+
+bool BatchedUDPTransport::open_socket()
+{
+    fd_ = socket(AF_INET6, SOCK_DGRAM, 0);
+    if (-1 == fd_)
+    {
+        return false;
+    }
+
+    int v6_only = 0;
+    setsockopt(fd_, IPPROTO_IPV6, IPV6_V6ONLY, &v6_only, sizeof(v6_only));
+
+    if (0 < reuse_port_group_)
+    {
+        int reuse_port = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &reuse_port, sizeof(reuse_port));
+    }
+
+    struct sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_port = htons(port_);
+    address.sin6_addr = in6addr_any;
+    if (-1 == bind(fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)))
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    // The program is shared by the group, every socket attaches the same one.
+    if (0 < reuse_port_group_ && !attach_client_key_steering(fd_, uint32_t(reuse_port_group_)))
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK);
+    if (-1 == event_fd_)
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    for (size_t i = 0; i < batch_size_; ++i)
+    {
+        recv_iovecs_[i].iov_base = recv_buffers_[i].data();
+        recv_iovecs_[i].iov_len = recv_buffers_[i].size();
+        recv_msgs_[i].msg_hdr = {};
+        recv_msgs_[i].msg_hdr.msg_name = &recv_addresses_[i];
+        recv_msgs_[i].msg_hdr.msg_iov = &recv_iovecs_[i];
+        recv_msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+    received_ = 0;
+    next_ = 0;
+    pending_ = 0;
+
+    return true;
+}
+
+bool BatchedUDPTransport::close_socket()
+{
+    std::lock_guard<std::mutex> lock(send_mtx_);
+    if (-1 == fd_)
+    {
+        return true;
+    }
+
+    flush();
+    bool closed = (0 == ::close(fd_));
+    closed = (0 == ::close(event_fd_)) && closed;
+    fd_ = -1;
+    event_fd_ = -1;
+    return closed;
+}
+
+ssize_t BatchedUDPTransport::recv(
+        eprosima::uxr::CustomEndPoint* source_endpoint,
+        uint8_t* buffer,
+        size_t buffer_length,
+        int timeout,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeout);
+
+    while (next_ == received_)
+    {
+        Clock::time_point wake = deadline;
+        {
+            std::lock_guard<std::mutex> lock(send_mtx_);
+            if (0 < pending_)
+            {
+                if (flush_time_ <= Clock::now())
+                {
+                    flush();
+                }
+                else
+                {
+                    wake = std::min(wake, flush_time_);
+                }
+            }
+        }
+
+        Clock::time_point now = Clock::now();
+        if (now >= deadline)
+        {
+            transport_rc = eprosima::uxr::TransportRc::timeout_error;
+            return 0;
+        }
+
+        int64_t wait = (wake > now) ? std::chrono::duration_cast<std::chrono::nanoseconds>(wake - now).count() : 0;
+        struct timespec wait_time = {time_t(wait / 1000000000), long(wait % 1000000000)};
+        struct pollfd fds[2] = {{fd_, POLLIN, 0}, {event_fd_, POLLIN, 0}};
+        int poll_rv = ppoll(fds, 2, &wait_time, nullptr);
+        if (-1 == poll_rv)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            transport_rc = eprosima::uxr::TransportRc::server_error;
+            return 0;
+        }
+
+        if (0 != (fds[1].revents & POLLIN))
+        {
+            // A datagram was queued for sending, its deadline is taken at the next iteration.
+            uint64_t events;
+            ssize_t drained = ::read(event_fd_, &events, sizeof(events));
+            (void) drained;
+        }
+
+        if (0 != (fds[0].revents & POLLIN))
+        {
+            for (size_t i = 0; i < batch_size_; ++i)
+            {
+                recv_msgs_[i].msg_hdr.msg_namelen = sizeof(recv_addresses_[i]);
+                recv_msgs_[i].msg_hdr.msg_flags = 0;
+            }
+
+            int count = recvmmsg(fd_, recv_msgs_.data(), unsigned(batch_size_), MSG_DONTWAIT, nullptr);
+            ++recv_calls_;
+            if (0 < count)
+            {
+                received_ = size_t(count);
+                next_ = 0;
+                recv_datagrams_ += uint64_t(count);
+            }
+        }
+    }
+
+    size_t index = next_++;
+    const struct mmsghdr& msg = recv_msgs_[index];
+    if (buffer_length < msg.msg_len || 0 != (msg.msg_hdr.msg_flags & MSG_TRUNC))
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+        return 0;
+    }
+
+    std::memcpy(buffer, recv_buffers_[index].data(), msg.msg_len);
+    address_to_endpoint(recv_addresses_[index], source_endpoint);
+    return static_cast<ssize_t>(msg.msg_len);
+}
+
+ssize_t BatchedUDPTransport::send(
+        const eprosima::uxr::CustomEndPoint* destination_endpoint,
+        uint8_t* buffer,
+        size_t message_length,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    std::lock_guard<std::mutex> lock(send_mtx_);
+
+    // The buffer keeps its capacity, there is no allocation once the batch is warm.
+    size_t slot = pending_++;
+    send_buffers_[slot].assign(buffer, buffer + message_length);
+    endpoint_to_address(destination_endpoint, send_addresses_[slot]);
+    send_iovecs_[slot].iov_base = send_buffers_[slot].data();
+    send_iovecs_[slot].iov_len = send_buffers_[slot].size();
+    send_msgs_[slot].msg_hdr = {};
+    send_msgs_[slot].msg_hdr.msg_name = &send_addresses_[slot];
+    send_msgs_[slot].msg_hdr.msg_namelen = sizeof(send_addresses_[slot]);
+    send_msgs_[slot].msg_hdr.msg_iov = &send_iovecs_[slot];
+    send_msgs_[slot].msg_hdr.msg_iovlen = 1;
+
+    if (batch_size_ == pending_ || 0 == flush_deadline_.count())
+    {
+        flush();
+    }
+    else if (1 == pending_)
+    {
+        // Wake up the receiver thread, which flushes the batch on the deadline.
+        flush_time_ = Clock::now() + flush_deadline_;
+        uint64_t event = 1;
+        ssize_t signaled = ::write(event_fd_, &event, sizeof(event));
+        (void) signaled;
+    }
+
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    return static_cast<ssize_t>(message_length);
+}
+
+ssize_t BatchedUDPTransport::sendv(
+        const eprosima::uxr::CustomEndPoint* destination_endpoint,
+        const custom_transport_slice* slices,
+        size_t slice_count,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    std::lock_guard<std::mutex> lock(send_mtx_);
+
+    // The queued datagrams were written before, they leave first.
+    if (0 < pending_)
+    {
+        flush();
+    }
+
+    // The iovecs keep their capacity, there is no allocation once warm.
+    sendv_iovecs_.resize(slice_count);
+    for (size_t i = 0; i < slice_count; ++i)
+    {
+        sendv_iovecs_[i].iov_base = const_cast<uint8_t*>(slices[i].data);
+        sendv_iovecs_[i].iov_len = slices[i].length;
+    }
+
+    struct sockaddr_in6 address;
+    endpoint_to_address(destination_endpoint, address);
+    struct msghdr msg = {};
+    msg.msg_name = &address;
+    msg.msg_namelen = sizeof(address);
+    msg.msg_iov = sendv_iovecs_.data();
+    msg.msg_iovlen = slice_count;
+
+    ssize_t sent;
+    do
+    {
+        sent = sendmsg(fd_, &msg, 0);
+        ++send_calls_;
+    }
+    while (-1 == sent && EINTR == errno);
+
+    if (-1 == sent)
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+        return 0;
+    }
+
+    ++send_datagrams_;
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    return sent;
+}
+
+void BatchedUDPTransport::flush()
+{
+    size_t sent = 0;
+    while (sent < pending_)
+    {
+        int count = sendmmsg(fd_, &send_msgs_[sent], unsigned(pending_ - sent), 0);
+        ++send_calls_;
+        if (0 < count)
+        {
+            sent += size_t(count);
+            send_datagrams_ += uint64_t(count);
+        }
+        else if (EINTR != errno)
+        {
+            // The datagram at the head is dropped, as a failed sendto would.
+            ++sent;
+        }
+    }
+    pending_ = 0;
+}
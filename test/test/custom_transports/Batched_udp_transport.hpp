@@ -0,0 +1,128 @@
+#ifndef IN_TEST_BATCHED_UDP_TRANSPORT_HPP
+#define IN_TEST_BATCHED_UDP_TRANSPORT_HPP
+
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
+
+#include "Custom_transport_slice.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/*
+ * UDP transport for the CustomAgent moving up to batch_size datagrams per syscall (Linux only).
+ *
+ * - Receive: recvmmsg drains the socket into a batch, handed to the Agent one datagram per call.
+ * - Send: datagrams are queued and flushed with sendmmsg when the batch is full or when the oldest
+ *   one has waited flush_deadline. A zero deadline flushes every datagram right away.
+ * - Vectored send: the slices of a message are gathered by a single sendmsg, with no staging copy.
+ *   They do not outlive the call, so the queued datagrams are flushed first instead of batching them.
+ *
+ * The socket is dual stack, IPv4 clients are identified by their IPv4-mapped IPv6 address.
+ *
+ * With reuse_port_group set, the socket joins a SO_REUSEPORT group of that many sockets on the same port.
+ * Messages carrying the client key in their header are steered to the socket key % reuse_port_group,
+ * the rest by the kernel hash of the source endpoint, so a client always reaches the same socket.
+ */
+class BatchedUDPTransport
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Scatter-gather variant of CustomAgent::SendMsgFunction.
+    using SendMsgvFunction = std::function<ssize_t (
+                const eprosima::uxr::CustomEndPoint*,
+                const custom_transport_slice*,
+                size_t,
+                eprosima::uxr::TransportRc&)>;
+
+    struct Stats
+    {
+        uint64_t recv_calls;
+        uint64_t recv_datagrams;
+        uint64_t send_calls;
+        uint64_t send_datagrams;
+    };
+
+    BatchedUDPTransport(
+            uint16_t port,
+            size_t batch_size = 32,
+            std::chrono::microseconds flush_deadline = std::chrono::microseconds(200),
+            size_t reuse_port_group = 0);
+
+    ~BatchedUDPTransport();
+
+    // Members identifying a client on the CustomEndPoint: address, as two 64 bits halves, and port.
+    static void add_members(eprosima::uxr::CustomEndPoint& endpoint);
+
+    Stats get_stats() const;
+
+    eprosima::uxr::CustomAgent::InitFunction open;
+    eprosima::uxr::CustomAgent::FiniFunction close;
+    eprosima::uxr::CustomAgent::SendMsgFunction write;
+    eprosima::uxr::CustomAgent::RecvMsgFunction read;
+    SendMsgvFunction writev;
+
+private:
+    bool open_socket();
+    bool close_socket();
+
+    ssize_t recv(
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    ssize_t send(
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    ssize_t sendv(
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            const custom_transport_slice* slices,
+            size_t slice_count,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    // Sends the queued datagrams, send_mtx_ must be held.
+    void flush();
+
+    uint16_t port_;
+    size_t batch_size_;
+    std::chrono::microseconds flush_deadline_;
+    size_t reuse_port_group_;
+    int fd_;
+    int event_fd_;
+
+    // Receive batch, only used by the Agent receiver thread.
+    std::vector<std::vector<uint8_t>> recv_buffers_;
+    std::vector<struct sockaddr_in6> recv_addresses_;
+    std::vector<struct iovec> recv_iovecs_;
+    std::vector<struct mmsghdr> recv_msgs_;
+    size_t received_;
+    size_t next_;
+
+    // Send batch, shared with the receiver thread for the deadline flush.
+    std::mutex send_mtx_;
+    std::vector<std::vector<uint8_t>> send_buffers_;
+    std::vector<struct sockaddr_in6> send_addresses_;
+    std::vector<struct iovec> send_iovecs_;
+    std::vector<struct mmsghdr> send_msgs_;
+    size_t pending_;
+    Clock::time_point flush_time_;
+    std::vector<struct iovec> sendv_iovecs_;
+
+    std::atomic<uint64_t> recv_calls_;
+    std::atomic<uint64_t> recv_datagrams_;
+    std::atomic<uint64_t> send_calls_;
+    std::atomic<uint64_t> send_datagrams_;
+};
+
+#endif //IN_TEST_BATCHED_UDP_TRANSPORT_HPP
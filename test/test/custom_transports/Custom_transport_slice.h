@@ -0,0 +1,27 @@
+#ifndef IN_TEST_CUSTOM_TRANSPORT_SLICE_H
+#define IN_TEST_CUSTOM_TRANSPORT_SLICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif // __cplusplus
+
+/*
+ * Scatter-gather send: a message given as slices (header, subheader, payload), sent in order
+ * without assembling it in a staging buffer first, as sendmsg or a DMA descriptor chain do.
+ */
+typedef struct custom_transport_slice
+{
+    const uint8_t* data;
+    size_t length;
+
+} custom_transport_slice;
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // IN_TEST_CUSTOM_TRANSPORT_SLICE_H
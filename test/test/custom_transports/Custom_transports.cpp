@@ -1,8 +1,7 @@
 #include "Custom_transports.hpp"
-#include <uxr/client/util/time.h>
 
 #include <chrono>
-#include <thread>
+#include <condition_variable>
 #include <queue>
 
 using packet_fifo = std::queue<std::vector<uint8_t>>;
@@ -15,6 +14,11 @@ static std::map<int32_t, stream_fifo> agent_to_client_stream_queue;
 
 std::mutex transport_mtx;
 
+// Signaled by the writes, so the reads sleep until there is data instead of polling the queues.
+// Packet and stream readers share them, so every write wakes all of them.
+static std::condition_variable to_agent_cv;
+static std::condition_variable to_client_cv;
+
 template <class T>
 static int32_t find_queue_with_data(const std::map<int32_t, T>& m)
 {
@@ -62,39 +66,33 @@ eprosima::uxr::CustomAgent::RecvMsgFunction agent_custom_transport_read_packet =
         eprosima::uxr::TransportRc& transport_rc) -> ssize_t
 {
     size_t rv = 0;
-    int64_t init_time = uxr_millis();
+    int32_t index = -1;
     bool received = false;
 
     transport_rc = eprosima::uxr::TransportRc::ok;
 
-    while (uxr_millis() - init_time < timeout)
-    {   
-        std::unique_lock<std::mutex> lock(transport_mtx);
-
-        int32_t index = find_queue_with_data(client_to_agent_packet_queue);
-        if (0 <= index)
+    std::unique_lock<std::mutex> lock(transport_mtx);
+    if (to_agent_cv.wait_for(lock, std::chrono::milliseconds(timeout), [&index]()
         {
-            auto data = client_to_agent_packet_queue[index].front();
-            client_to_agent_packet_queue[index].pop();
+            index = find_queue_with_data(client_to_agent_packet_queue);
+            return 0 <= index;
+        }))
+    {
+        auto data = client_to_agent_packet_queue[index].front();
+        client_to_agent_packet_queue[index].pop();
 
-            if (data.size() <= buffer_length)
-            {
-                std::copy(data.begin(), data.end(), buffer);
-                rv = data.size();
-                received = true;
-                std::cout << "Custom agent receive: " << rv << " bytes in queue " <<  index << std::endl;
-                source_endpoint->set_member_value<uint32_t>("index", static_cast<uint32_t>(index));
-            }
-            else
-            {
-                transport_rc = eprosima::uxr::TransportRc::server_error;
-            }
-            
-            break;
+        if (data.size() <= buffer_length)
+        {
+            std::copy(data.begin(), data.end(), buffer);
+            rv = data.size();
+            received = true;
+            std::cout << "Custom agent receive: " << rv << " bytes in queue " <<  index << std::endl;
+            source_endpoint->set_member_value<uint32_t>("index", static_cast<uint32_t>(index));
+        }
+        else
+        {
+            transport_rc = eprosima::uxr::TransportRc::server_error;
         }
-
-        lock.unlock();
-        std::this_thread::sleep_for(std::chrono::microseconds(10));
     }
     
     if (!received)
@@ -116,6 +114,7 @@ eprosima::uxr::CustomAgent::SendMsgFunction agent_custom_transport_write_packet
 
     std::vector<uint8_t> packet(buffer, buffer + message_length);
     agent_to_client_packet_queue[index].emplace(std::move(packet));
+    to_client_cv.notify_all();
     transport_rc = eprosima::uxr::TransportRc::ok;
     std::cout << "Custom agent send: " << message_length << " bytes." << std::endl;
 
@@ -130,38 +129,32 @@ eprosima::uxr::CustomAgent::RecvMsgFunction agent_custom_transport_read_stream =
         eprosima::uxr::TransportRc& transport_rc) -> ssize_t
 {
     size_t rv = 0;
-    int64_t init_time = uxr_millis();
+    int32_t index = -1;
     bool received = false;
 
     transport_rc = eprosima::uxr::TransportRc::ok;
 
-    while (uxr_millis() - init_time < timeout)
-    {   
-        std::unique_lock<std::mutex> lock(transport_mtx);
-
-        int32_t index = find_queue_with_data(client_to_agent_stream_queue);
-        if (0 <= index)
+    std::unique_lock<std::mutex> lock(transport_mtx);
+    if (to_agent_cv.wait_for(lock, std::chrono::milliseconds(timeout), [&index]()
         {
-            rv = (buffer_length > client_to_agent_stream_queue[index].size()) ?
-                               client_to_agent_stream_queue[index].size() :
-                               buffer_length;
+            index = find_queue_with_data(client_to_agent_stream_queue);
+            return 0 <= index;
+        }))
+    {
+        rv = (buffer_length > client_to_agent_stream_queue[index].size()) ?
+                           client_to_agent_stream_queue[index].size() :
+                           buffer_length;
 
-            for (size_t i = 0; i < rv; i++)
-            {
-                buffer[i] = client_to_agent_stream_queue[index].front();
-                client_to_agent_stream_queue[index].pop();
-            }
-            
-            std::cout << "Custom agent receive: " << rv << " bytes in queue " << index << std::endl;
-            
-            source_endpoint->set_member_value<uint32_t>("index", static_cast<uint32_t>(index));
-            received = true;
-            
-            break;
+        for (size_t i = 0; i < rv; i++)
+        {
+            buffer[i] = client_to_agent_stream_queue[index].front();
+            client_to_agent_stream_queue[index].pop();
         }
- 
-        lock.unlock();
-        std::this_thread::sleep_for(std::chrono::microseconds(10));
+        
+        std::cout << "Custom agent receive: " << rv << " bytes in queue " << index << std::endl;
+        
+        source_endpoint->set_member_value<uint32_t>("index", static_cast<uint32_t>(index));
+        received = true;
     }
     
     if (!received)
@@ -185,6 +178,7 @@ eprosima::uxr::CustomAgent::SendMsgFunction agent_custom_transport_write_stream
     {
         agent_to_client_stream_queue[index].emplace(buffer[i]);
     }
+    to_client_cv.notify_all();
     
     transport_rc = eprosima::uxr::TransportRc::ok;
     std::cout << "Custom agent send: " << message_length << " bytes to queue " << index << std::endl;
@@ -234,6 +228,7 @@ extern "C"
 
         std::vector<uint8_t> packet(buf, buf + len);
         client_to_agent_packet_queue[index].emplace(std::move(packet));
+        to_agent_cv.notify_all();
         std::cout << "Custom client send: " << len << " bytes in queue " << index << std::endl;
 
         return len;
@@ -245,33 +240,26 @@ extern "C"
         int32_t index = *(int32_t*) transport->args;
 
         size_t rv = 0;
-        int64_t init_time = uxr_millis();
 
-        while (uxr_millis() - init_time < timeout)
+        std::unique_lock<std::mutex> lock(transport_mtx);
+        if (to_client_cv.wait_for(lock, std::chrono::milliseconds(timeout), [index]()
+            {
+                return 0 < agent_to_client_packet_queue[index].size();
+            }))
         {
-            std::unique_lock<std::mutex> lock(transport_mtx);
+            auto data = agent_to_client_packet_queue[index].front();
+            agent_to_client_packet_queue[index].pop();
 
-            if (0 < agent_to_client_packet_queue[index].size())
+            if (data.size() <= len)
             {
-                auto data = agent_to_client_packet_queue[index].front();
-                agent_to_client_packet_queue[index].pop();
-
-                if (data.size() <= len)
-                {
-                    std::copy( data.begin(), data.end(), buf);
-                    rv = data.size();
-                    std::cout << "Custom client receive: " << len << " bytes in queue " << index << std::endl;
-                }
-                else
-                {
-                    *errcode = 1;
-                }
-                
-                break;
+                std::copy( data.begin(), data.end(), buf);
+                rv = data.size();
+                std::cout << "Custom client receive: " << len << " bytes in queue " << index << std::endl;
+            }
+            else
+            {
+                *errcode = 1;
             }
-            
-            lock.unlock();
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
         }
         
         return rv;
@@ -289,6 +277,7 @@ extern "C"
         {
             client_to_agent_stream_queue[index].emplace(buf[i]);
         }
+        to_agent_cv.notify_all();
 
         std::cout << "Custom client send: " << len << " bytes in queue " << index << std::endl;
 
@@ -301,28 +290,22 @@ extern "C"
         int32_t index = *(int32_t*) transport->args;
 
         size_t rv = 0;
-        int64_t init_time = uxr_millis();
 
-        while (uxr_millis() - init_time < timeout)
+        std::unique_lock<std::mutex> lock(transport_mtx);
+        if (to_client_cv.wait_for(lock, std::chrono::milliseconds(timeout), [index]()
+            {
+                return 0 < agent_to_client_stream_queue[index].size();
+            }))
         {
-            std::unique_lock<std::mutex> lock(transport_mtx);
+            rv = (len > agent_to_client_stream_queue[index].size()) ?
+                  agent_to_client_stream_queue[index].size() :
+                  len;
 
-            if (0 < agent_to_client_stream_queue[index].size())
+            for (size_t i = 0; i < rv; i++)
             {
-                rv = (len > agent_to_client_stream_queue[index].size()) ?
-                      agent_to_client_stream_queue[index].size() :
-                      len;
-
-                for (size_t i = 0; i < rv; i++)
-                {
-                    buf[i] = agent_to_client_stream_queue[index].front();
-                    agent_to_client_stream_queue[index].pop();
-                }
-                
-                break;
+                buf[i] = agent_to_client_stream_queue[index].front();
+                agent_to_client_stream_queue[index].pop();
             }
-            lock.unlock();
-            std::this_thread::sleep_for(std::chrono::microseconds(10));
         }
         
         return rv;
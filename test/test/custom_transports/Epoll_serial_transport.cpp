@@ -0,0 +1,574 @@
+#include "Epoll_serial_transport.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Ports are identified by their slab index, below 2^16, and a generation in the upper bits.
+static const size_t MAX_SLAB_SIZE = 65536;
+
+static const size_t MAX_EVENTS = 256;
+static const size_t RECV_BUFFER_SIZE = 4096;
+static const size_t BUFFER_POOL_SIZE = 64;
+
+// Output kept per port while its line is full, beyond that messages are dropped.
+static const size_t MAX_PENDING_OUTPUT = 1 << 16;
+
+static const uint8_t FRAMING_BEGIN_FLAG = 0x7E;
+static const uint8_t FRAMING_ESC_FLAG = 0x7D;
+static const uint8_t FRAMING_XOR_FLAG = 0x20;
+
+// CRC-16 of the XRCE serial framing (polynomial 0x8005 reflected, initial value 0) over the payload.
+struct CrcTable
+{
+    uint16_t values[256];
+
+    CrcTable()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint16_t crc = uint16_t(i);
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (0 != (crc & 1)) ? uint16_t((crc >> 1) ^ 0xA001) : uint16_t(crc >> 1);
+            }
+            values[i] = crc;
+        }
+    }
+};
+
+static const CrcTable crc_table;
+
+static uint16_t update_crc(uint16_t crc, uint8_t octet)
+{
+    return uint16_t((crc >> 8) ^ crc_table.values[(crc ^ octet) & 0xFF]);
+}
+
+static void add_octet(std::vector<uint8_t>& frame, uint8_t octet)
+{
+    if (FRAMING_BEGIN_FLAG == octet || FRAMING_ESC_FLAG == octet)
+    {
+        frame.push_back(FRAMING_ESC_FLAG);
+        frame.push_back(uint8_t(octet ^ FRAMING_XOR_FLAG));
+    }
+    else
+    {
+        frame.push_back(octet);
+    }
+}
+
+static uint32_t port_id(uint32_t index, uint32_t generation)
+{
+    return ((generation & 0xFFFF) << 16) | index;
+}
+
+EpollSerialTransport::EpollSerialTransport(
+        const std::vector<std::string>& devices,
+        const struct termios& attributes,
+        uint8_t address,
+        size_t max_ports)
+    : devices_(devices)
+    , attributes_(attributes)
+    , address_(address)
+    , epoll_fd_(-1)
+    , ports_(std::min(std::max(max_ports, size_t(1)), MAX_SLAB_SIZE))
+    , events_(MAX_EVENTS)
+    , recv_buffer_(RECV_BUFFER_SIZE)
+{
+    open = [this]() -> bool
+    {
+        return open_ports();
+    };
+
+    close = [this]() -> bool
+    {
+        return close_ports();
+    };
+
+    write = [this](
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return send(destination_endpoint, buffer, message_length, transport_rc);
+    };
+
+    read = [this](
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return recv(source_endpoint, buffer, buffer_length, timeout, transport_rc);
+    };
+}
+
+EpollSerialTransport::~EpollSerialTransport()
+{
+    close_ports();
+}
+
+void EpollSerialTransport::add_members(eprosima::uxr::CustomEndPoint& endpoint)
+{
+    try
+    {
+        endpoint.add_member<uint32_t>("port");
+        endpoint.add_member<uint8_t>("address");
+    }
+    catch(const std::exception& /*e*/)
+    {
+        // Already added by a previous Agent.
+    }
+}
+
+int EpollSerialTransport::add_port(const std::string& device)
+{
+    std::lock_guard<std::mutex> ports_lock(ports_mtx_);
+    if (-1 == epoll_fd_ || free_ports_.empty())
+    {
+        return -1;
+    }
+
+    int fd = ::open(device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (-1 == fd)
+    {
+        return -1;
+    }
+
+    if (0 != tcsetattr(fd, TCSANOW, &attributes_))
+    {
+        ::close(fd);
+        return -1;
+    }
+
+    uint32_t index = free_ports_.back();
+    Port& port = ports_[index];
+    std::lock_guard<std::mutex> lock(port.mtx);
+    port.fd = fd;
+    ++port.generation;
+    port.state = ReadState::BEGIN;
+    port.escaped = false;
+    port.output.clear();
+    port.sent = 0;
+
+    // Events carry the generation, so those of a removed port are not taken for its successor.
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    event.data.u64 = port_id(index, port.generation);
+    if (-1 == epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event))
+    {
+        close_port(port);
+        return -1;
+    }
+
+    free_ports_.pop_back();
+    return fd;
+}
+
+bool EpollSerialTransport::remove_port(int fd)
+{
+    std::lock_guard<std::mutex> ports_lock(ports_mtx_);
+    for (uint32_t i = 0; i < uint32_t(ports_.size()); ++i)
+    {
+        Port& port = ports_[i];
+        std::lock_guard<std::mutex> lock(port.mtx);
+        if (-1 != fd && port.fd == fd)
+        {
+            close_port(port);
+            free_ports_.push_back(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<int> EpollSerialTransport::get_fds() const
+{
+    std::lock_guard<std::mutex> ports_lock(ports_mtx_);
+    std::vector<int> fds;
+    for (const Port& port : ports_)
+    {
+        if (-1 != port.fd)
+        {
+            fds.push_back(port.fd);
+        }
+    }
+    return fds;
+}
+
+bool EpollSerialTransport::open_ports()
+{
+    {
+        std::lock_guard<std::mutex> ports_lock(ports_mtx_);
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (-1 == epoll_fd_)
+        {
+            return false;
+        }
+
+        free_ports_.clear();
+        for (uint32_t i = uint32_t(ports_.size()); 0 < i; --i)
+        {
+            free_ports_.push_back(i - 1);
+        }
+        ready_.clear();
+    }
+
+    for (const std::string& device : devices_)
+    {
+        if (-1 == add_port(device))
+        {
+            close_ports();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool EpollSerialTransport::close_ports()
+{
+    std::lock_guard<std::mutex> ports_lock(ports_mtx_);
+    if (-1 == epoll_fd_)
+    {
+        return true;
+    }
+
+    for (Port& port : ports_)
+    {
+        std::lock_guard<std::mutex> lock(port.mtx);
+        close_port(port);
+    }
+    free_ports_.clear();
+
+    bool closed = (0 == ::close(epoll_fd_));
+    epoll_fd_ = -1;
+    ready_.clear();
+    return closed;
+}
+
+ssize_t EpollSerialTransport::recv(
+        eprosima::uxr::CustomEndPoint* source_endpoint,
+        uint8_t* buffer,
+        size_t buffer_length,
+        int timeout,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    transport_rc = eprosima::uxr::TransportRc::ok;
+
+    if (ready_.empty())
+    {
+        poll_events(timeout);
+    }
+
+    if (ready_.empty())
+    {
+        transport_rc = eprosima::uxr::TransportRc::timeout_error;
+        return 0;
+    }
+
+    ssize_t rv = 0;
+    Message& message = ready_.front();
+    if (buffer_length < message.data.size())
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+    }
+    else
+    {
+        std::memcpy(buffer, message.data.data(), message.data.size());
+        source_endpoint->set_member_value<uint32_t>("port", message.port);
+        source_endpoint->set_member_value<uint8_t>("address", message.source);
+        rv = static_cast<ssize_t>(message.data.size());
+    }
+
+    give_buffer(std::move(message.data));
+    ready_.pop_front();
+    return rv;
+}
+
+ssize_t EpollSerialTransport::send(
+        const eprosima::uxr::CustomEndPoint* destination_endpoint,
+        uint8_t* buffer,
+        size_t message_length,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    uint32_t id = destination_endpoint->get_member<uint32_t>("port");
+    uint32_t index = id & 0xFFFF;
+    if (ports_.size() <= index)
+    {
+        transport_rc = eprosima::uxr::TransportRc::connection_error;
+        return 0;
+    }
+
+    Port& destination = ports_[index];
+    std::lock_guard<std::mutex> lock(destination.mtx);
+    if (-1 == destination.fd || port_id(index, destination.generation) != id)
+    {
+        transport_rc = eprosima::uxr::TransportRc::connection_error;
+        return 0;
+    }
+
+    // Worst case, every octet escaped.
+    size_t frame_bound = 1 + 2 * (2 + 2 + message_length + 2);
+    if (UINT16_MAX < message_length
+        || MAX_PENDING_OUTPUT < destination.output.size() - destination.sent + frame_bound)
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+        return 0;
+    }
+
+    // The frame is appended to the output queue, written right away when the queue was empty.
+    std::vector<uint8_t>& frame = destination.output;
+    frame.push_back(FRAMING_BEGIN_FLAG);
+    add_octet(frame, address_);
+    add_octet(frame, destination_endpoint->get_member<uint8_t>("address"));
+    add_octet(frame, uint8_t(message_length & 0xFF));
+    add_octet(frame, uint8_t(message_length >> 8));
+    uint16_t crc = 0;
+    for (size_t i = 0; i < message_length; ++i)
+    {
+        add_octet(frame, buffer[i]);
+        crc = update_crc(crc, buffer[i]);
+    }
+    add_octet(frame, uint8_t(crc & 0xFF));
+    add_octet(frame, uint8_t(crc >> 8));
+
+    flush_port(destination);
+
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    return static_cast<ssize_t>(message_length);
+}
+
+void EpollSerialTransport::poll_events(int timeout)
+{
+    int count = epoll_wait(epoll_fd_, events_.data(), int(events_.size()), timeout);
+    for (int i = 0; i < count; ++i)
+    {
+        const struct epoll_event& event = events_[size_t(i)];
+        uint32_t id = uint32_t(event.data.u64);
+        uint32_t index = id & 0xFFFF;
+        if (0 != (event.events & EPOLLIN))
+        {
+            read_port(index, id);
+        }
+        if (0 != (event.events & EPOLLOUT))
+        {
+            Port& port = ports_[index];
+            std::lock_guard<std::mutex> lock(port.mtx);
+            if (-1 != port.fd && port_id(index, port.generation) == id)
+            {
+                flush_port(port);
+            }
+        }
+    }
+}
+
+void EpollSerialTransport::read_port(uint32_t index, uint32_t id)
+{
+    Port& port = ports_[index];
+    std::lock_guard<std::mutex> lock(port.mtx);
+    if (-1 == port.fd || port_id(index, port.generation) != id)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        ssize_t bytes_read = ::read(port.fd, recv_buffer_.data(), recv_buffer_.size());
+        if (0 < bytes_read)
+        {
+            consume(index, recv_buffer_.data(), size_t(bytes_read));
+        }
+        else if (-1 == bytes_read && EINTR == errno)
+        {
+            continue;
+        }
+        else
+        {
+            // Drained, or no peer on the line (EIO) until it comes back and raises a new edge.
+            return;
+        }
+    }
+}
+
+void EpollSerialTransport::consume(uint32_t index, const uint8_t* data, size_t length)
+{
+    Port& port = ports_[index];
+    for (size_t i = 0; i < length; ++i)
+    {
+        uint8_t octet = data[i];
+
+        // A begin flag always starts a new frame, dropping a truncated one.
+        if (FRAMING_BEGIN_FLAG == octet)
+        {
+            if (ReadState::PAYLOAD == port.state)
+            {
+                give_buffer(std::move(port.message));
+                port.message = std::vector<uint8_t>();
+            }
+            port.state = ReadState::SOURCE_ADDRESS;
+            port.escaped = false;
+            continue;
+        }
+        if (ReadState::BEGIN == port.state)
+        {
+            continue;
+        }
+        if (FRAMING_ESC_FLAG == octet)
+        {
+            port.escaped = true;
+            continue;
+        }
+        if (port.escaped)
+        {
+            octet = uint8_t(octet ^ FRAMING_XOR_FLAG);
+            port.escaped = false;
+        }
+
+        switch (port.state)
+        {
+            case ReadState::SOURCE_ADDRESS:
+            {
+                port.source = octet;
+                port.state = ReadState::DESTINATION_ADDRESS;
+                break;
+            }
+            case ReadState::DESTINATION_ADDRESS:
+            {
+                port.state = (address_ == octet) ? ReadState::LENGTH_LSB : ReadState::BEGIN;
+                break;
+            }
+            case ReadState::LENGTH_LSB:
+            {
+                port.length = octet;
+                port.state = ReadState::LENGTH_MSB;
+                break;
+            }
+            case ReadState::LENGTH_MSB:
+            {
+                port.length = uint16_t(port.length | (uint16_t(octet) << 8));
+                if (0 < port.length)
+                {
+                    port.message = take_buffer();
+                    port.message.resize(port.length);
+                    port.received = 0;
+                    port.crc = 0;
+                    port.state = ReadState::PAYLOAD;
+                }
+                else
+                {
+                    port.state = ReadState::BEGIN;
+                }
+                break;
+            }
+            case ReadState::PAYLOAD:
+            {
+                port.message[port.received++] = octet;
+                port.crc = update_crc(port.crc, octet);
+                if (port.length == port.received)
+                {
+                    port.state = ReadState::CRC_LSB;
+                }
+                break;
+            }
+            case ReadState::CRC_LSB:
+            {
+                port.received_crc = octet;
+                port.state = ReadState::CRC_MSB;
+                break;
+            }
+            case ReadState::CRC_MSB:
+            {
+                port.received_crc = uint16_t(port.received_crc | (uint16_t(octet) << 8));
+                if (port.crc == port.received_crc)
+                {
+                    Message message;
+                    message.port = port_id(index, port.generation);
+                    message.source = port.source;
+                    message.data = std::move(port.message);
+                    ready_.push_back(std::move(message));
+                }
+                else
+                {
+                    give_buffer(std::move(port.message));
+                }
+                port.message = std::vector<uint8_t>();
+                port.state = ReadState::BEGIN;
+                break;
+            }
+            case ReadState::BEGIN:
+                break;
+        }
+    }
+}
+
+void EpollSerialTransport::close_port(Port& port)
+{
+    if (-1 == port.fd)
+    {
+        return;
+    }
+
+    // Closing the descriptor removes it from the epoll set. A partial input message is dropped
+    // here instead of pooled, the pool belongs to the receiver thread.
+    ::close(port.fd);
+    port.fd = -1;
+    port.state = ReadState::BEGIN;
+    std::vector<uint8_t>().swap(port.message);
+    std::vector<uint8_t>().swap(port.output);
+    port.sent = 0;
+}
+
+std::vector<uint8_t> EpollSerialTransport::take_buffer()
+{
+    if (buffer_pool_.empty())
+    {
+        return std::vector<uint8_t>();
+    }
+
+    std::vector<uint8_t> buffer = std::move(buffer_pool_.back());
+    buffer_pool_.pop_back();
+    return buffer;
+}
+
+void EpollSerialTransport::give_buffer(std::vector<uint8_t>&& buffer)
+{
+    // Pooled buffers keep their capacity, so a message in flight allocates nothing once warm.
+    if (buffer_pool_.size() < BUFFER_POOL_SIZE)
+    {
+        buffer_pool_.push_back(std::move(buffer));
+    }
+}
+
+void EpollSerialTransport::flush_port(Port& port)
+{
+    while (port.sent < port.output.size())
+    {
+        ssize_t bytes_written = ::write(port.fd, &port.output[port.sent], port.output.size() - port.sent);
+        if (0 < bytes_written)
+        {
+            port.sent += size_t(bytes_written);
+        }
+        else if (-1 == bytes_written && EINTR == errno)
+        {
+            continue;
+        }
+        else if (-1 == bytes_written && (EAGAIN == errno || EWOULDBLOCK == errno))
+        {
+            // Full, the rest waits for the next EPOLLOUT edge.
+            return;
+        }
+        else
+        {
+            // Nobody on the line to take it.
+            break;
+        }
+    }
+    port.output.clear();
+    port.sent = 0;
+}
@@ -0,0 +1,141 @@
+#ifndef IN_TEST_EPOLL_SERIAL_TRANSPORT_HPP
+#define IN_TEST_EPOLL_SERIAL_TRANSPORT_HPP
+
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <termios.h>
+
+/*
+ * Multi-port serial transport for the CustomAgent driven by an edge-triggered epoll reactor (Linux only).
+ *
+ * - One epoll set holds every port, so a wake up costs the same with 2 or 128 ports and idle
+ *   ports cost nothing. Ports live in a slab of max_ports slots.
+ * - Each port reassembles the XRCE serial framing on its own (begin flag, source and destination
+ *   addresses, length, escaped payload and CRC), so bytes of several lines never mix.
+ * - Ports are added and removed while the Agent runs, a line can be plugged in without restarting it.
+ * - Writes are non-blocking. What the line does not take is kept in the output queue of the port
+ *   and flushed on the next EPOLLOUT edge, so a slow port never stalls the others.
+ *
+ * A port without a peer (a pseudo-terminal with no slave open, a detached line) stays in the set
+ * and is served again as soon as its peer comes back.
+ */
+class EpollSerialTransport
+{
+public:
+    EpollSerialTransport(
+            const std::vector<std::string>& devices,
+            const struct termios& attributes,
+            uint8_t address = 0,
+            size_t max_ports = 256);
+
+    ~EpollSerialTransport();
+
+    // Members identifying a client on the CustomEndPoint: its port and its framing address.
+    static void add_members(eprosima::uxr::CustomEndPoint& endpoint);
+
+    // Opens a device and adds it to the reactor, returns its descriptor or -1.
+    int add_port(const std::string& device);
+
+    // Removes the port of a descriptor returned by add_port, closing it.
+    bool remove_port(int fd);
+
+    // Descriptors of the open ports, in slot order.
+    std::vector<int> get_fds() const;
+
+    eprosima::uxr::CustomAgent::InitFunction open;
+    eprosima::uxr::CustomAgent::FiniFunction close;
+    eprosima::uxr::CustomAgent::SendMsgFunction write;
+    eprosima::uxr::CustomAgent::RecvMsgFunction read;
+
+private:
+    enum class ReadState
+    {
+        BEGIN,
+        SOURCE_ADDRESS,
+        DESTINATION_ADDRESS,
+        LENGTH_LSB,
+        LENGTH_MSB,
+        PAYLOAD,
+        CRC_LSB,
+        CRC_MSB
+    };
+
+    struct Port
+    {
+        std::mutex mtx;
+        int fd = -1;
+        uint32_t generation = 0;
+
+        // Input state machine, only used by the receiver thread.
+        ReadState state = ReadState::BEGIN;
+        bool escaped = false;
+        uint8_t source = 0;
+        uint16_t length = 0;
+        uint16_t crc = 0;
+        uint16_t received_crc = 0;
+        size_t received = 0;
+        std::vector<uint8_t> message;
+
+        // Output the line did not take, from sent on.
+        std::vector<uint8_t> output;
+        size_t sent = 0;
+    };
+
+    struct Message
+    {
+        uint32_t port;
+        uint8_t source;
+        std::vector<uint8_t> data;
+    };
+
+    bool open_ports();
+    bool close_ports();
+
+    ssize_t recv(
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    ssize_t send(
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    // Receiver thread only.
+    void poll_events(int timeout);
+    void read_port(uint32_t index, uint32_t port_id);
+    void consume(uint32_t index, const uint8_t* data, size_t length);
+    std::vector<uint8_t> take_buffer();
+    void give_buffer(std::vector<uint8_t>&& buffer);
+
+    // Port mutex held.
+    void close_port(Port& port);
+    void flush_port(Port& port);
+
+    std::vector<std::string> devices_;
+    struct termios attributes_;
+    uint8_t address_;
+    int epoll_fd_;
+
+    // Guards the free list, add_port and remove_port run on any thread.
+    mutable std::mutex ports_mtx_;
+    std::vector<Port> ports_;
+    std::vector<uint32_t> free_ports_;
+
+    // Receiver thread state.
+    std::vector<struct epoll_event> events_;
+    std::vector<uint8_t> recv_buffer_;
+    std::deque<Message> ready_;
+    std::vector<std::vector<uint8_t>> buffer_pool_;
+};
+
+#endif //IN_TEST_EPOLL_SERIAL_TRANSPORT_HPP
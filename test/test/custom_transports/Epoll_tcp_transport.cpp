@@ -0,0 +1,522 @@
+#include "Epoll_tcp_transport.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Connections are identified by their slab index, below 2^16, and a generation in the upper bits.
+static const size_t MAX_SLAB_SIZE = 65536;
+
+static const uint64_t LISTENER_KEY = UINT64_MAX;
+static const size_t MAX_EVENTS = 256;
+static const size_t RECV_BUFFER_SIZE = 65536;
+static const size_t BUFFER_POOL_SIZE = 64;
+
+// Output kept per connection while its socket is full, beyond that messages are dropped.
+static const size_t MAX_PENDING_OUTPUT = 1 << 20;
+
+static uint32_t connection_id(uint32_t index, uint32_t generation)
+{
+    return ((generation & 0xFFFF) << 16) | index;
+}
+
+static void address_to_endpoint(
+        const struct sockaddr_in6& address,
+        uint32_t connection,
+        eprosima::uxr::CustomEndPoint* endpoint)
+{
+    uint64_t high;
+    uint64_t low;
+    std::memcpy(&high, &address.sin6_addr.s6_addr[0], sizeof(high));
+    std::memcpy(&low, &address.sin6_addr.s6_addr[8], sizeof(low));
+    endpoint->set_member_value<uint64_t>("address_high", high);
+    endpoint->set_member_value<uint64_t>("address_low", low);
+    endpoint->set_member_value<uint16_t>("port", ntohs(address.sin6_port));
+    endpoint->set_member_value<uint32_t>("connection", connection);
+}
+
+EpollTCPTransport::EpollTCPTransport(
+        uint16_t port,
+        size_t max_connections)
+    : port_(port)
+    , fd_(-1)
+    , epoll_fd_(-1)
+    , connections_(std::min(std::max(max_connections, size_t(1)), MAX_SLAB_SIZE))
+    , open_connections_(0)
+    , events_(MAX_EVENTS)
+    , recv_buffer_(RECV_BUFFER_SIZE)
+{
+    open = [this]() -> bool
+    {
+        return open_socket();
+    };
+
+    close = [this]() -> bool
+    {
+        return close_socket();
+    };
+
+    write = [this](
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return send(destination_endpoint, buffer, message_length, transport_rc);
+    };
+
+    read = [this](
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return recv(source_endpoint, buffer, buffer_length, timeout, transport_rc);
+    };
+}
+
+EpollTCPTransport::~EpollTCPTransport()
+{
+    close_socket();
+}
+
+void EpollTCPTransport::add_members(eprosima::uxr::CustomEndPoint& endpoint)
+{
+    try
+    {
+        endpoint.add_member<uint64_t>("address_high");
+        endpoint.add_member<uint64_t>("address_low");
+        endpoint.add_member<uint16_t>("port");
+        endpoint.add_member<uint32_t>("connection");
+    }
+    catch(const std::exception& /*e*/)
+    {
+        // Already added by a previous Agent.
+    }
+}
+
+size_t EpollTCPTransport::get_connections() const
+{
+    return open_connections_;
+}
+
+bool EpollTCPTransport::open_socket()
+{
+    fd_ = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (-1 == fd_)
+    {
+        return false;
+    }
+
+    int v6_only = 0;
+    setsockopt(fd_, IPPROTO_IPV6, IPV6_V6ONLY, &v6_only, sizeof(v6_only));
+    int reuse_address = 1;
+    setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse_address, sizeof(reuse_address));
+
+    struct sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_port = htons(port_);
+    address.sin6_addr = in6addr_any;
+    if (-1 == bind(fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address))
+        || -1 == listen(fd_, SOMAXCONN))
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.u64 = LISTENER_KEY;
+    if (-1 == epoll_fd_ || -1 == epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd_, &event))
+    {
+        if (-1 != epoll_fd_)
+        {
+            ::close(epoll_fd_);
+            epoll_fd_ = -1;
+        }
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    free_connections_.clear();
+    for (uint32_t i = uint32_t(connections_.size()); 0 < i; --i)
+    {
+        free_connections_.push_back(i - 1);
+    }
+    ready_.clear();
+    open_connections_ = 0;
+
+    return true;
+}
+
+bool EpollTCPTransport::close_socket()
+{
+    if (-1 == fd_)
+    {
+        return true;
+    }
+
+    for (uint32_t i = 0; i < uint32_t(connections_.size()); ++i)
+    {
+        close_connection(i);
+    }
+
+    bool closed = (0 == ::close(fd_));
+    closed = (0 == ::close(epoll_fd_)) && closed;
+    fd_ = -1;
+    epoll_fd_ = -1;
+    ready_.clear();
+    return closed;
+}
+
+ssize_t EpollTCPTransport::recv(
+        eprosima::uxr::CustomEndPoint* source_endpoint,
+        uint8_t* buffer,
+        size_t buffer_length,
+        int timeout,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    transport_rc = eprosima::uxr::TransportRc::ok;
+
+    if (ready_.empty())
+    {
+        poll_events(timeout);
+    }
+
+    if (ready_.empty())
+    {
+        transport_rc = eprosima::uxr::TransportRc::timeout_error;
+        return 0;
+    }
+
+    ssize_t rv = 0;
+    Message& message = ready_.front();
+    if (buffer_length < message.data.size())
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+    }
+    else
+    {
+        std::memcpy(buffer, message.data.data(), message.data.size());
+        address_to_endpoint(message.address, message.connection, source_endpoint);
+        rv = static_cast<ssize_t>(message.data.size());
+    }
+
+    give_buffer(std::move(message.data));
+    ready_.pop_front();
+    return rv;
+}
+
+ssize_t EpollTCPTransport::send(
+        const eprosima::uxr::CustomEndPoint* destination_endpoint,
+        uint8_t* buffer,
+        size_t message_length,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    uint32_t connection = destination_endpoint->get_member<uint32_t>("connection");
+    uint32_t index = connection & 0xFFFF;
+    if (connections_.size() <= index)
+    {
+        transport_rc = eprosima::uxr::TransportRc::connection_error;
+        return 0;
+    }
+
+    Connection& destination = connections_[index];
+    std::lock_guard<std::mutex> lock(destination.mtx);
+    if (-1 == destination.fd || connection_id(index, destination.generation) != connection)
+    {
+        transport_rc = eprosima::uxr::TransportRc::connection_error;
+        return 0;
+    }
+
+    uint8_t header[2] = {uint8_t(message_length & 0xFF), uint8_t((message_length >> 8) & 0xFF)};
+    size_t written = 0;
+    if (destination.output.empty())
+    {
+        struct iovec iovecs[2] = {{header, sizeof(header)}, {buffer, message_length}};
+        struct msghdr msg = {};
+        msg.msg_iov = iovecs;
+        msg.msg_iovlen = 2;
+        ssize_t bytes_sent = sendmsg(destination.fd, &msg, MSG_NOSIGNAL);
+        if (-1 == bytes_sent && EAGAIN != errno && EWOULDBLOCK != errno)
+        {
+            // The receiver thread closes the connection on its error event.
+            transport_rc = eprosima::uxr::TransportRc::connection_error;
+            return 0;
+        }
+        written = (0 < bytes_sent) ? size_t(bytes_sent) : 0;
+    }
+    else if (MAX_PENDING_OUTPUT < destination.output.size() - destination.sent + sizeof(header) + message_length)
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+        return 0;
+    }
+
+    // Whatever the socket did not take waits for the next EPOLLOUT edge.
+    if (written < sizeof(header))
+    {
+        destination.output.insert(destination.output.end(), header + written, header + sizeof(header));
+        destination.output.insert(destination.output.end(), buffer, buffer + message_length);
+    }
+    else if (written < sizeof(header) + message_length)
+    {
+        destination.output.insert(destination.output.end(), buffer + (written - sizeof(header)), buffer + message_length);
+    }
+
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    return static_cast<ssize_t>(message_length);
+}
+
+void EpollTCPTransport::poll_events(int timeout)
+{
+    int count = epoll_wait(epoll_fd_, events_.data(), int(events_.size()), timeout);
+    for (int i = 0; i < count; ++i)
+    {
+        const struct epoll_event& event = events_[size_t(i)];
+        if (LISTENER_KEY == event.data.u64)
+        {
+            accept_connections();
+            continue;
+        }
+
+        // Events of a connection closed earlier in this batch find an empty slot, or a new
+        // connection which reads nothing and has nothing to flush.
+        uint32_t index = uint32_t(event.data.u64);
+        if (0 != (event.events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)))
+        {
+            read_connection(index);
+        }
+        if (0 != (event.events & EPOLLOUT))
+        {
+            Connection& connection = connections_[index];
+            std::lock_guard<std::mutex> lock(connection.mtx);
+            if (-1 != connection.fd)
+            {
+                flush_connection(connection);
+            }
+        }
+    }
+}
+
+void EpollTCPTransport::accept_connections()
+{
+    // Edge triggered, the backlog is drained until accept would block.
+    for (;;)
+    {
+        struct sockaddr_in6 address = {};
+        socklen_t address_length = sizeof(address);
+        int fd = accept4(fd_, reinterpret_cast<struct sockaddr*>(&address), &address_length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (-1 == fd)
+        {
+            if (EINTR == errno || ECONNABORTED == errno)
+            {
+                continue;
+            }
+            break;
+        }
+
+        if (free_connections_.empty())
+        {
+            ::close(fd);
+            continue;
+        }
+
+        uint32_t index = free_connections_.back();
+        free_connections_.pop_back();
+        Connection& connection = connections_[index];
+        {
+            std::lock_guard<std::mutex> lock(connection.mtx);
+            connection.fd = fd;
+            ++connection.generation;
+            connection.address = address;
+            connection.state = ReadState::LENGTH_LSB;
+            connection.received = 0;
+            connection.output.clear();
+            connection.sent = 0;
+        }
+        ++open_connections_;
+
+        int no_delay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+        struct epoll_event event = {};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.u64 = index;
+        if (-1 == epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event))
+        {
+            close_connection(index);
+        }
+    }
+}
+
+void EpollTCPTransport::read_connection(uint32_t index)
+{
+    Connection& connection = connections_[index];
+    if (-1 == connection.fd)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        ssize_t bytes_received = ::recv(connection.fd, recv_buffer_.data(), recv_buffer_.size(), 0);
+        if (0 < bytes_received)
+        {
+            consume(index, recv_buffer_.data(), size_t(bytes_received));
+
+            // A short read drained the socket, new data raises a new edge.
+            if (size_t(bytes_received) < recv_buffer_.size())
+            {
+                return;
+            }
+        }
+        else if (-1 == bytes_received && EINTR == errno)
+        {
+            continue;
+        }
+        else if (-1 == bytes_received && (EAGAIN == errno || EWOULDBLOCK == errno))
+        {
+            return;
+        }
+        else
+        {
+            // Closed by the peer or failed.
+            close_connection(index);
+            return;
+        }
+    }
+}
+
+void EpollTCPTransport::consume(uint32_t index, const uint8_t* data, size_t length)
+{
+    Connection& connection = connections_[index];
+    while (0 < length)
+    {
+        switch (connection.state)
+        {
+            case ReadState::LENGTH_LSB:
+            {
+                connection.length = data[0];
+                connection.state = ReadState::LENGTH_MSB;
+                ++data;
+                --length;
+                break;
+            }
+            case ReadState::LENGTH_MSB:
+            {
+                connection.length = uint16_t(connection.length | (uint16_t(data[0]) << 8));
+                ++data;
+                --length;
+                if (0 < connection.length)
+                {
+                    connection.message = take_buffer();
+                    connection.message.resize(connection.length);
+                    connection.received = 0;
+                    connection.state = ReadState::MESSAGE;
+                }
+                else
+                {
+                    connection.state = ReadState::LENGTH_LSB;
+                }
+                break;
+            }
+            case ReadState::MESSAGE:
+            {
+                size_t chunk = std::min(length, size_t(connection.length) - connection.received);
+                std::memcpy(&connection.message[connection.received], data, chunk);
+                connection.received += chunk;
+                data += chunk;
+                length -= chunk;
+                if (connection.length == connection.received)
+                {
+                    Message message;
+                    message.connection = connection_id(index, connection.generation);
+                    message.address = connection.address;
+                    message.data = std::move(connection.message);
+                    ready_.push_back(std::move(message));
+                    connection.message = std::vector<uint8_t>();
+                    connection.state = ReadState::LENGTH_LSB;
+                }
+                break;
+            }
+        }
+    }
+}
+
+void EpollTCPTransport::close_connection(uint32_t index)
+{
+    Connection& connection = connections_[index];
+    std::lock_guard<std::mutex> lock(connection.mtx);
+    if (-1 == connection.fd)
+    {
+        return;
+    }
+
+    // Closing the descriptor removes it from the epoll set.
+    ::close(connection.fd);
+    connection.fd = -1;
+    if (ReadState::MESSAGE == connection.state)
+    {
+        give_buffer(std::move(connection.message));
+        connection.message = std::vector<uint8_t>();
+    }
+    connection.state = ReadState::LENGTH_LSB;
+    std::vector<uint8_t>().swap(connection.output);
+    connection.sent = 0;
+
+    free_connections_.push_back(index);
+    --open_connections_;
+}
+
+std::vector<uint8_t> EpollTCPTransport::take_buffer()
+{
+    if (buffer_pool_.empty())
+    {
+        return std::vector<uint8_t>();
+    }
+
+    std::vector<uint8_t> buffer = std::move(buffer_pool_.back());
+    buffer_pool_.pop_back();
+    return buffer;
+}
+
+void EpollTCPTransport::give_buffer(std::vector<uint8_t>&& buffer)
+{
+    // Pooled buffers keep their capacity, so a message in flight allocates nothing once warm.
+    if (buffer_pool_.size() < BUFFER_POOL_SIZE)
+    {
+        buffer_pool_.push_back(std::move(buffer));
+    }
+}
+
+void EpollTCPTransport::flush_connection(Connection& connection)
+{
+    while (connection.sent < connection.output.size())
+    {
+        ssize_t bytes_sent = ::send(connection.fd, &connection.output[connection.sent],
+                connection.output.size() - connection.sent, MSG_NOSIGNAL);
+        if (0 < bytes_sent)
+        {
+            connection.sent += size_t(bytes_sent);
+        }
+        else if (-1 == bytes_sent && EINTR == errno)
+        {
+            continue;
+        }
+        else
+        {
+            // Full again, or failed and about to be closed by its error event.
+            return;
+        }
+    }
+    connection.output.clear();
+    connection.sent = 0;
+}
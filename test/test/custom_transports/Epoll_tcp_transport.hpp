@@ -0,0 +1,122 @@
+#ifndef IN_TEST_EPOLL_TCP_TRANSPORT_HPP
+#define IN_TEST_EPOLL_TCP_TRANSPORT_HPP
+
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/epoll.h>
+
+/*
+ * TCP transport for the CustomAgent driven by an edge-triggered epoll reactor (Linux only).
+ *
+ * - Connections live in a slab of max_connections slots allocated up front. A slot holds the
+ *   state machine reassembling the XRCE framing (2 bytes little endian length, then the message)
+ *   and the output not taken by the socket yet. Idle connections own no buffers.
+ * - The receiver thread only wakes up for sockets with events, so the cost of a wake up does not
+ *   depend on the number of connections, and idle ones cost nothing.
+ * - Messages are sent from the caller thread. What the socket does not take is kept in the slot
+ *   and flushed on the next EPOLLOUT edge.
+ *
+ * The socket is dual stack, IPv4 clients are identified by their IPv4-mapped IPv6 address.
+ */
+class EpollTCPTransport
+{
+public:
+    EpollTCPTransport(
+            uint16_t port,
+            size_t max_connections = 32768);
+
+    ~EpollTCPTransport();
+
+    // Members identifying a client on the CustomEndPoint: address, as two 64 bits halves, port and connection.
+    static void add_members(eprosima::uxr::CustomEndPoint& endpoint);
+
+    // Connections currently open.
+    size_t get_connections() const;
+
+    eprosima::uxr::CustomAgent::InitFunction open;
+    eprosima::uxr::CustomAgent::FiniFunction close;
+    eprosima::uxr::CustomAgent::SendMsgFunction write;
+    eprosima::uxr::CustomAgent::RecvMsgFunction read;
+
+private:
+    enum class ReadState
+    {
+        LENGTH_LSB,
+        LENGTH_MSB,
+        MESSAGE
+    };
+
+    struct Connection
+    {
+        std::mutex mtx;
+        int fd = -1;
+        uint32_t generation = 0;
+        struct sockaddr_in6 address;
+
+        // Input state machine, only used by the receiver thread.
+        ReadState state = ReadState::LENGTH_LSB;
+        uint16_t length = 0;
+        size_t received = 0;
+        std::vector<uint8_t> message;
+
+        // Output the socket did not take, from sent on.
+        std::vector<uint8_t> output;
+        size_t sent = 0;
+    };
+
+    struct Message
+    {
+        uint32_t connection;
+        struct sockaddr_in6 address;
+        std::vector<uint8_t> data;
+    };
+
+    bool open_socket();
+    bool close_socket();
+
+    ssize_t recv(
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    ssize_t send(
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    // Receiver thread only.
+    void poll_events(int timeout);
+    void accept_connections();
+    void read_connection(uint32_t index);
+    void consume(uint32_t index, const uint8_t* data, size_t length);
+    void close_connection(uint32_t index);
+    std::vector<uint8_t> take_buffer();
+    void give_buffer(std::vector<uint8_t>&& buffer);
+
+    // Writes the pending output until the socket is full, the connection mutex must be held.
+    void flush_connection(Connection& connection);
+
+    uint16_t port_;
+    int fd_;
+    int epoll_fd_;
+    std::vector<Connection> connections_;
+    std::atomic<size_t> open_connections_;
+
+    // Receiver thread state.
+    std::vector<uint32_t> free_connections_;
+    std::vector<struct epoll_event> events_;
+    std::vector<uint8_t> recv_buffer_;
+    std::deque<Message> ready_;
+    std::vector<std::vector<uint8_t>> buffer_pool_;
+};
+
+#endif //IN_TEST_EPOLL_TCP_TRANSPORT_HPP
@@ -0,0 +1,735 @@
+#include "Io_uring_transport.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <netinet/tcp.h>
+#include <unistd.h>
+
+static const unsigned RING_ENTRIES = 1024;
+static const unsigned SQ_THREAD_IDLE_MS = 100;
+
+// Registered receive buffers, the count must be a power of two. Larger datagrams are dropped.
+static const unsigned BUFFER_COUNT = 256;
+static const size_t BUFFER_SIZE = 8192;
+static const unsigned short BUFFER_GROUP = 0;
+
+// Connections are identified by their slab index, below 2^16, and a generation in the upper bits.
+static const uint32_t MAX_CONNECTIONS = 1024;
+
+static const size_t SEND_SLOTS = 256;
+static const std::chrono::milliseconds SEND_SLOT_TIMEOUT(100);
+
+enum Operation : uint64_t
+{
+    RECVMSG = 1,
+    ACCEPT,
+    RECV,
+    SEND
+};
+
+static uint64_t user_data(Operation operation, uint64_t index)
+{
+    return (uint64_t(operation) << 32) | index;
+}
+
+static uint32_t connection_id(uint32_t index, uint32_t generation)
+{
+    return ((generation & 0xFFFF) << 16) | index;
+}
+
+static void address_to_endpoint(
+        const struct sockaddr_in6& address,
+        uint32_t connection,
+        eprosima::uxr::CustomEndPoint* endpoint)
+{
+    uint64_t high;
+    uint64_t low;
+    std::memcpy(&high, &address.sin6_addr.s6_addr[0], sizeof(high));
+    std::memcpy(&low, &address.sin6_addr.s6_addr[8], sizeof(low));
+    endpoint->set_member_value<uint64_t>("address_high", high);
+    endpoint->set_member_value<uint64_t>("address_low", low);
+    endpoint->set_member_value<uint16_t>("port", ntohs(address.sin6_port));
+    endpoint->set_member_value<uint32_t>("connection", connection);
+}
+
+static void endpoint_to_address(const eprosima::uxr::CustomEndPoint* endpoint, struct sockaddr_in6& address)
+{
+    uint64_t high = endpoint->get_member<uint64_t>("address_high");
+    uint64_t low = endpoint->get_member<uint64_t>("address_low");
+    address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_port = htons(endpoint->get_member<uint16_t>("port"));
+    std::memcpy(&address.sin6_addr.s6_addr[0], &high, sizeof(high));
+    std::memcpy(&address.sin6_addr.s6_addr[8], &low, sizeof(low));
+}
+
+IoUringTransport::IoUringTransport(
+        Protocol protocol,
+        uint16_t port)
+    : protocol_(protocol)
+    , port_(port)
+    , fd_(-1)
+    , ring_open_(false)
+    , ring_{}
+    , buf_ring_(nullptr)
+    , recv_msg_{}
+    , held_buffers_(0)
+    , starving_(false)
+{
+    open = [this]() -> bool
+    {
+        return open_ring();
+    };
+
+    close = [this]() -> bool
+    {
+        return close_ring();
+    };
+
+    write = [this](
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return send(destination_endpoint, buffer, message_length, transport_rc);
+    };
+
+    read = [this](
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return recv(source_endpoint, buffer, buffer_length, timeout, transport_rc);
+    };
+}
+
+IoUringTransport::~IoUringTransport()
+{
+    close_ring();
+}
+
+bool IoUringTransport::is_supported()
+{
+    struct io_uring_probe* probe = io_uring_get_probe();
+    if (nullptr == probe)
+    {
+        return false;
+    }
+
+    // Multishot recv and recvmsg have no probe, they came in Linux 6.0 along with zero copy send.
+    bool supported = io_uring_opcode_supported(probe, IORING_OP_RECVMSG)
+        && io_uring_opcode_supported(probe, IORING_OP_ACCEPT)
+        && io_uring_opcode_supported(probe, IORING_OP_SEND_ZC);
+    io_uring_free_probe(probe);
+    return supported;
+}
+
+void IoUringTransport::add_members(eprosima::uxr::CustomEndPoint& endpoint)
+{
+    try
+    {
+        endpoint.add_member<uint64_t>("address_high");
+        endpoint.add_member<uint64_t>("address_low");
+        endpoint.add_member<uint16_t>("port");
+        endpoint.add_member<uint32_t>("connection");
+    }
+    catch(const std::exception& /*e*/)
+    {
+        // Already added by a previous Agent.
+    }
+}
+
+bool IoUringTransport::open_ring()
+{
+    bool udp = (Protocol::UDP == protocol_);
+    fd_ = socket(AF_INET6, udp ? SOCK_DGRAM : SOCK_STREAM, 0);
+    if (-1 == fd_)
+    {
+        return false;
+    }
+
+    int v6_only = 0;
+    setsockopt(fd_, IPPROTO_IPV6, IPV6_V6ONLY, &v6_only, sizeof(v6_only));
+    if (!udp)
+    {
+        int reuse_address = 1;
+        setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse_address, sizeof(reuse_address));
+    }
+
+    struct sockaddr_in6 address = {};
+    address.sin6_family = AF_INET6;
+    address.sin6_port = htons(port_);
+    address.sin6_addr = in6addr_any;
+    if (-1 == bind(fd_, reinterpret_cast<struct sockaddr*>(&address), sizeof(address))
+        || (!udp && -1 == listen(fd_, SOMAXCONN)))
+    {
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    struct io_uring_params params = {};
+    params.flags = IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = SQ_THREAD_IDLE_MS;
+    if (0 != io_uring_queue_init_params(RING_ENTRIES, &ring_, &params))
+    {
+        // SQPOLL needs privileges before Linux 5.11, submissions go through io_uring_enter instead.
+        params = {};
+        if (0 != io_uring_queue_init_params(RING_ENTRIES, &ring_, &params))
+        {
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+    }
+    ring_open_ = true;
+
+    int rv;
+    buf_ring_ = io_uring_setup_buf_ring(&ring_, BUFFER_COUNT, BUFFER_GROUP, 0, &rv);
+    if (nullptr == buf_ring_)
+    {
+        close_ring();
+        return false;
+    }
+
+    buffers_.assign(BUFFER_COUNT * BUFFER_SIZE, 0);
+    for (unsigned i = 0; i < BUFFER_COUNT; ++i)
+    {
+        io_uring_buf_ring_add(buf_ring_, &buffers_[i * BUFFER_SIZE], BUFFER_SIZE,
+            static_cast<unsigned short>(i), io_uring_buf_ring_mask(BUFFER_COUNT), int(i));
+    }
+    io_uring_buf_ring_advance(buf_ring_, BUFFER_COUNT);
+    held_buffers_ = 0;
+    starving_ = false;
+    starving_connections_.clear();
+
+    // Multishot recvmsg lays the source address out in the buffer, next to the payload.
+    recv_msg_ = {};
+    recv_msg_.msg_namelen = sizeof(struct sockaddr_in6);
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    ready_.clear();
+    connections_.assign(udp ? 0 : MAX_CONNECTIONS, Connection());
+    free_connections_.clear();
+    for (uint32_t i = uint32_t(connections_.size()); 0 < i; --i)
+    {
+        free_connections_.push_back(i - 1);
+    }
+    send_slots_.resize(SEND_SLOTS);
+    free_send_slots_.clear();
+    for (size_t i = 0; i < SEND_SLOTS; ++i)
+    {
+        free_send_slots_.push_back(i);
+    }
+
+    if (udp)
+    {
+        arm_recvmsg();
+    }
+    else
+    {
+        arm_accept();
+    }
+    return 0 <= io_uring_submit(&ring_);
+}
+
+bool IoUringTransport::close_ring()
+{
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (!ring_open_)
+    {
+        return true;
+    }
+
+    for (Connection& connection : connections_)
+    {
+        if (-1 != connection.fd)
+        {
+            ::close(connection.fd);
+            connection.fd = -1;
+        }
+    }
+
+    if (nullptr != buf_ring_)
+    {
+        io_uring_free_buf_ring(&ring_, buf_ring_, BUFFER_COUNT, BUFFER_GROUP);
+        buf_ring_ = nullptr;
+    }
+
+    // Exiting the ring cancels the pending requests.
+    io_uring_queue_exit(&ring_);
+    ring_open_ = false;
+    ready_.clear();
+    connections_.clear();
+    free_connections_.clear();
+
+    bool closed = (0 == ::close(fd_));
+    fd_ = -1;
+    send_slot_cv_.notify_all();
+    return closed;
+}
+
+ssize_t IoUringTransport::recv(
+        eprosima::uxr::CustomEndPoint* source_endpoint,
+        uint8_t* buffer,
+        size_t buffer_length,
+        int timeout,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    transport_rc = eprosima::uxr::TransportRc::ok;
+
+    bool empty;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        empty = ready_.empty();
+    }
+    if (empty)
+    {
+        reap(timeout);
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    if (ready_.empty())
+    {
+        transport_rc = eprosima::uxr::TransportRc::timeout_error;
+        return 0;
+    }
+
+    ssize_t rv = 0;
+    Message& message = ready_.front();
+    if (buffer_length < message.length)
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+    }
+    else
+    {
+        std::memcpy(buffer, (0 <= message.buffer_id) ? message.data : message.owned.data(), message.length);
+        address_to_endpoint(message.address, message.connection, source_endpoint);
+        rv = static_cast<ssize_t>(message.length);
+    }
+
+    if (0 <= message.buffer_id)
+    {
+        recycle(message.buffer_id);
+    }
+    ready_.pop_front();
+    return rv;
+}
+
+ssize_t IoUringTransport::send(
+        const eprosima::uxr::CustomEndPoint* destination_endpoint,
+        uint8_t* buffer,
+        size_t message_length,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    std::unique_lock<std::mutex> lock(mtx_);
+
+    // The slots bound the messages in flight, their completions are reaped by the receiver thread.
+    if (!send_slot_cv_.wait_for(lock, SEND_SLOT_TIMEOUT, [this]{ return !ring_open_ || !free_send_slots_.empty(); })
+        || !ring_open_)
+    {
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+        return 0;
+    }
+
+    size_t slot = free_send_slots_.back();
+    free_send_slots_.pop_back();
+    SendSlot& send_slot = send_slots_[slot];
+
+    if (Protocol::UDP == protocol_)
+    {
+        // The buffer keeps its capacity, there is no allocation once the slot is warm.
+        send_slot.data.assign(buffer, buffer + message_length);
+        endpoint_to_address(destination_endpoint, send_slot.address);
+        send_slot.iovec.iov_base = send_slot.data.data();
+        send_slot.iovec.iov_len = send_slot.data.size();
+        send_slot.msg = {};
+        send_slot.msg.msg_name = &send_slot.address;
+        send_slot.msg.msg_namelen = sizeof(send_slot.address);
+        send_slot.msg.msg_iov = &send_slot.iovec;
+        send_slot.msg.msg_iovlen = 1;
+
+        struct io_uring_sqe* sqe = get_sqe();
+        io_uring_prep_sendmsg(sqe, fd_, &send_slot.msg, 0);
+        io_uring_sqe_set_data64(sqe, user_data(SEND, slot));
+    }
+    else
+    {
+        uint32_t connection = destination_endpoint->get_member<uint32_t>("connection");
+        uint32_t index = connection & 0xFFFF;
+        if (connections_.size() <= index
+            || -1 == connections_[index].fd
+            || connections_[index].closing
+            || connection_id(index, connections_[index].generation) != connection)
+        {
+            free_send_slot(slot);
+            transport_rc = eprosima::uxr::TransportRc::connection_error;
+            return 0;
+        }
+
+        send_slot.data.resize(2 + message_length);
+        send_slot.data[0] = uint8_t(message_length & 0xFF);
+        send_slot.data[1] = uint8_t((message_length >> 8) & 0xFF);
+        std::memcpy(&send_slot.data[2], buffer, message_length);
+        send_slot.connection = connection;
+
+        // One send in flight per connection keeps the frames in order across partial sends.
+        Connection& destination = connections_[index];
+        destination.output.push_back(slot);
+        if (1 == destination.output.size())
+        {
+            submit_send(index);
+        }
+    }
+
+    io_uring_submit(&ring_);
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    return static_cast<ssize_t>(message_length);
+}
+
+void IoUringTransport::reap(int timeout)
+{
+    // With extended arguments (Linux 5.11) the timeout does not take an entry of the submission ring,
+    // so the wait needs no lock against the senders.
+    struct __kernel_timespec wait_time = {timeout / 1000, (timeout % 1000) * 1000000LL};
+    struct io_uring_cqe* cqe = nullptr;
+    if (0 != io_uring_wait_cqe_timeout(&ring_, &cqe, &wait_time))
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    unsigned head;
+    unsigned count = 0;
+    io_uring_for_each_cqe(&ring_, head, cqe)
+    {
+        handle(cqe);
+        ++count;
+    }
+    io_uring_cq_advance(&ring_, count);
+    io_uring_submit(&ring_);
+}
+
+void IoUringTransport::handle(const struct io_uring_cqe* cqe)
+{
+    uint32_t index = uint32_t(cqe->user_data & 0xFFFFFFFF);
+    switch (cqe->user_data >> 32)
+    {
+        case RECVMSG:
+            on_recvmsg(cqe);
+            break;
+        case ACCEPT:
+            on_accept(cqe);
+            break;
+        case RECV:
+            on_recv(index, cqe);
+            break;
+        case SEND:
+            on_send(index, cqe);
+            break;
+        default:
+            break;
+    }
+}
+
+void IoUringTransport::on_recvmsg(const struct io_uring_cqe* cqe)
+{
+    if (0 != (cqe->flags & IORING_CQE_F_BUFFER))
+    {
+        int buffer_id = int(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        ++held_buffers_;
+
+        uint8_t* buffer = &buffers_[size_t(buffer_id) * BUFFER_SIZE];
+        struct io_uring_recvmsg_out* out = (0 < cqe->res)
+            ? io_uring_recvmsg_validate(buffer, cqe->res, &recv_msg_)
+            : nullptr;
+        if (nullptr != out && 0 == (out->flags & MSG_TRUNC) && sizeof(struct sockaddr_in6) <= out->namelen)
+        {
+            // The datagram stays in the registered buffer until the Agent reads it.
+            Message message;
+            std::memcpy(&message.address, io_uring_recvmsg_name(out), sizeof(message.address));
+            message.connection = 0;
+            message.data = static_cast<const uint8_t*>(io_uring_recvmsg_payload(out, &recv_msg_));
+            message.length = io_uring_recvmsg_payload_length(out, cqe->res, &recv_msg_);
+            message.buffer_id = buffer_id;
+            ready_.push_back(std::move(message));
+        }
+        else
+        {
+            recycle(buffer_id);
+        }
+    }
+
+    if (0 == (cqe->flags & IORING_CQE_F_MORE))
+    {
+        if (-ENOBUFS == cqe->res && BUFFER_COUNT == held_buffers_)
+        {
+            starving_ = true;
+        }
+        else
+        {
+            arm_recvmsg();
+        }
+    }
+}
+
+void IoUringTransport::on_accept(const struct io_uring_cqe* cqe)
+{
+    if (0 <= cqe->res)
+    {
+        int fd = cqe->res;
+        if (free_connections_.empty())
+        {
+            ::close(fd);
+        }
+        else
+        {
+            uint32_t index = free_connections_.back();
+            free_connections_.pop_back();
+
+            Connection& connection = connections_[index];
+            connection.fd = fd;
+            ++connection.generation;
+            connection.closing = false;
+            connection.input.clear();
+            connection.output.clear();
+            connection.sent = 0;
+            connection.address = {};
+            socklen_t address_length = sizeof(connection.address);
+            getpeername(fd, reinterpret_cast<struct sockaddr*>(&connection.address), &address_length);
+
+            int no_delay = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+            arm_recv(index);
+        }
+    }
+
+    if (0 == (cqe->flags & IORING_CQE_F_MORE))
+    {
+        arm_accept();
+    }
+}
+
+void IoUringTransport::on_recv(uint32_t index, const struct io_uring_cqe* cqe)
+{
+    Connection& connection = connections_[index];
+    bool more = (0 != (cqe->flags & IORING_CQE_F_MORE));
+    if (!more)
+    {
+        connection.receiving = false;
+    }
+
+    if (0 < cqe->res && 0 != (cqe->flags & IORING_CQE_F_BUFFER))
+    {
+        int buffer_id = int(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+        ++held_buffers_;
+        const uint8_t* data = &buffers_[size_t(buffer_id) * BUFFER_SIZE];
+        connection.input.insert(connection.input.end(), data, data + cqe->res);
+        recycle(buffer_id);
+
+        size_t offset = 0;
+        while (2 <= connection.input.size() - offset)
+        {
+            size_t length = size_t(connection.input[offset]) | (size_t(connection.input[offset + 1]) << 8);
+            if (connection.input.size() - offset - 2 < length)
+            {
+                break;
+            }
+
+            Message message;
+            message.address = connection.address;
+            message.connection = connection_id(index, connection.generation);
+            message.data = nullptr;
+            message.length = length;
+            message.buffer_id = -1;
+            message.owned.assign(connection.input.begin() + long(offset + 2), connection.input.begin() + long(offset + 2 + length));
+            ready_.push_back(std::move(message));
+            offset += 2 + length;
+        }
+        connection.input.erase(connection.input.begin(), connection.input.begin() + long(offset));
+
+        if (!more && !connection.closing)
+        {
+            arm_recv(index);
+        }
+    }
+    else if (-ENOBUFS == cqe->res && !connection.closing)
+    {
+        if (BUFFER_COUNT == held_buffers_)
+        {
+            starving_connections_.push_back(index);
+        }
+        else
+        {
+            arm_recv(index);
+        }
+    }
+    else
+    {
+        // Closed by the peer or failed.
+        close_connection(index);
+    }
+
+    release_connection(index);
+}
+
+void IoUringTransport::on_send(size_t slot, const struct io_uring_cqe* cqe)
+{
+    if (Protocol::UDP == protocol_)
+    {
+        // A failed datagram is dropped, as a failed sendto would.
+        free_send_slot(slot);
+        return;
+    }
+
+    uint32_t index = send_slots_[slot].connection & 0xFFFF;
+    Connection& connection = connections_[index];
+    if (0 < cqe->res && !connection.closing)
+    {
+        connection.sent += size_t(cqe->res);
+        if (connection.sent < send_slots_[slot].data.size())
+        {
+            submit_send(index);
+            return;
+        }
+    }
+    else
+    {
+        close_connection(index);
+    }
+
+    connection.output.pop_front();
+    connection.sent = 0;
+    free_send_slot(slot);
+
+    if (connection.closing)
+    {
+        release_connection(index);
+    }
+    else if (!connection.output.empty())
+    {
+        submit_send(index);
+    }
+}
+
+struct io_uring_sqe* IoUringTransport::get_sqe()
+{
+    struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    while (nullptr == sqe)
+    {
+        // Full submission ring, hand it to the kernel and wait for room.
+        io_uring_submit(&ring_);
+        io_uring_sqring_wait(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+    }
+    return sqe;
+}
+
+void IoUringTransport::arm_recvmsg()
+{
+    struct io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_recvmsg_multishot(sqe, fd_, &recv_msg_, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    io_uring_sqe_set_data64(sqe, user_data(RECVMSG, 0));
+}
+
+void IoUringTransport::arm_accept()
+{
+    struct io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_multishot_accept(sqe, fd_, nullptr, nullptr, 0);
+    io_uring_sqe_set_data64(sqe, user_data(ACCEPT, 0));
+}
+
+void IoUringTransport::arm_recv(uint32_t index)
+{
+    struct io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_recv_multishot(sqe, connections_[index].fd, nullptr, 0, 0);
+    sqe->flags |= IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    io_uring_sqe_set_data64(sqe, user_data(RECV, index));
+    connections_[index].receiving = true;
+}
+
+void IoUringTransport::submit_send(uint32_t index)
+{
+    Connection& connection = connections_[index];
+    size_t slot = connection.output.front();
+    const std::vector<uint8_t>& data = send_slots_[slot].data;
+
+    struct io_uring_sqe* sqe = get_sqe();
+    io_uring_prep_send(sqe, connection.fd, data.data() + connection.sent, data.size() - connection.sent, MSG_NOSIGNAL);
+    io_uring_sqe_set_data64(sqe, user_data(SEND, slot));
+}
+
+void IoUringTransport::close_connection(uint32_t index)
+{
+    Connection& connection = connections_[index];
+    if (connection.closing)
+    {
+        return;
+    }
+    connection.closing = true;
+
+    // Shutting the socket down completes its pending requests, the descriptor is closed by release_connection.
+    shutdown(connection.fd, SHUT_RDWR);
+    while (1 < connection.output.size())
+    {
+        free_send_slot(connection.output.back());
+        connection.output.pop_back();
+    }
+    release_connection(index);
+}
+
+void IoUringTransport::release_connection(uint32_t index)
+{
+    Connection& connection = connections_[index];
+    if (!connection.closing || connection.receiving || !connection.output.empty() || -1 == connection.fd)
+    {
+        return;
+    }
+
+    ::close(connection.fd);
+    connection.fd = -1;
+    connection.input.clear();
+    free_connections_.push_back(index);
+}
+
+void IoUringTransport::free_send_slot(size_t slot)
+{
+    free_send_slots_.push_back(slot);
+    send_slot_cv_.notify_one();
+}
+
+void IoUringTransport::recycle(int buffer_id)
+{
+    io_uring_buf_ring_add(buf_ring_, &buffers_[size_t(buffer_id) * BUFFER_SIZE], BUFFER_SIZE,
+        static_cast<unsigned short>(buffer_id), io_uring_buf_ring_mask(BUFFER_COUNT), 0);
+    io_uring_buf_ring_advance(buf_ring_, 1);
+    --held_buffers_;
+
+    bool rearmed = starving_ || !starving_connections_.empty();
+    if (starving_)
+    {
+        starving_ = false;
+        arm_recvmsg();
+    }
+    for (uint32_t index : starving_connections_)
+    {
+        if (!connections_[index].closing && !connections_[index].receiving && -1 != connections_[index].fd)
+        {
+            arm_recv(index);
+        }
+    }
+    starving_connections_.clear();
+
+    if (rearmed)
+    {
+        io_uring_submit(&ring_);
+    }
+}
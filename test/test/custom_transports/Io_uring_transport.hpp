@@ -0,0 +1,143 @@
+#ifndef IN_TEST_IO_URING_TRANSPORT_HPP
+#define IN_TEST_IO_URING_TRANSPORT_HPP
+
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <liburing.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+/*
+ * UDP and TCP transports for the CustomAgent on io_uring (Linux 6.0 and liburing 2.4 or later).
+ *
+ * - Receive: multishot recvmsg (UDP), or multishot accept and recv (TCP), into a ring of buffers
+ *   registered with the kernel. One io_uring_enter reaps any number of messages, and each one
+ *   is copied once, from the registered buffer to the Agent buffer.
+ * - Send: messages are copied to a pool of send slots and queued on the submission ring, polled
+ *   by a kernel thread (SQPOLL) when the process is allowed to, so there is no syscall per message.
+ *
+ * Sockets are dual stack, IPv4 clients are identified by their IPv4-mapped IPv6 address.
+ * TCP messages keep the XRCE framing, a 2 bytes little endian length before each message.
+ */
+class IoUringTransport
+{
+public:
+    enum class Protocol
+    {
+        UDP,
+        TCP
+    };
+
+    IoUringTransport(
+            Protocol protocol,
+            uint16_t port);
+
+    ~IoUringTransport();
+
+    // Whether the running kernel provides the io_uring operations used by the transport.
+    static bool is_supported();
+
+    // Members identifying a client on the CustomEndPoint: address, as two 64 bits halves, port and TCP connection.
+    static void add_members(eprosima::uxr::CustomEndPoint& endpoint);
+
+    eprosima::uxr::CustomAgent::InitFunction open;
+    eprosima::uxr::CustomAgent::FiniFunction close;
+    eprosima::uxr::CustomAgent::SendMsgFunction write;
+    eprosima::uxr::CustomAgent::RecvMsgFunction read;
+
+private:
+    struct Message
+    {
+        struct sockaddr_in6 address;
+        uint32_t connection;
+        const uint8_t* data;            // In the registered buffer buffer_id, or in owned if buffer_id is -1.
+        size_t length;
+        int buffer_id;
+        std::vector<uint8_t> owned;
+    };
+
+    struct Connection
+    {
+        int fd = -1;
+        uint32_t generation = 0;
+        struct sockaddr_in6 address;
+        bool receiving = false;
+        bool closing = false;
+        std::vector<uint8_t> input;     // Bytes of the frames not complete yet.
+        std::deque<size_t> output;      // Send slots, the front one is in flight.
+        size_t sent = 0;                // Bytes of the front slot already sent.
+    };
+
+    struct SendSlot
+    {
+        std::vector<uint8_t> data;
+        struct sockaddr_in6 address;
+        struct iovec iovec;
+        struct msghdr msg;
+        uint32_t connection;
+    };
+
+    bool open_ring();
+    bool close_ring();
+
+    ssize_t recv(
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    ssize_t send(
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    // Waits up to timeout for completions and handles them, filling ready_.
+    void reap(int timeout);
+
+    // Completion handlers and request submission, mtx_ must be held.
+    void handle(const struct io_uring_cqe* cqe);
+    void on_recvmsg(const struct io_uring_cqe* cqe);
+    void on_accept(const struct io_uring_cqe* cqe);
+    void on_recv(uint32_t index, const struct io_uring_cqe* cqe);
+    void on_send(size_t slot, const struct io_uring_cqe* cqe);
+    struct io_uring_sqe* get_sqe();
+    void arm_recvmsg();
+    void arm_accept();
+    void arm_recv(uint32_t index);
+    void submit_send(uint32_t index);
+    void close_connection(uint32_t index);
+    void release_connection(uint32_t index);
+    void free_send_slot(size_t slot);
+
+    // Gives a registered buffer back to the kernel, rearming the receptions which ran out of them.
+    void recycle(int buffer_id);
+
+    Protocol protocol_;
+    uint16_t port_;
+    int fd_;
+    bool ring_open_;
+    struct io_uring ring_;
+    struct io_uring_buf_ring* buf_ring_;
+    std::vector<uint8_t> buffers_;
+    struct msghdr recv_msg_;
+
+    std::mutex mtx_;
+    std::deque<Message> ready_;
+    size_t held_buffers_;
+    bool starving_;                     // A multishot reception ended for lack of buffers.
+    std::vector<uint32_t> starving_connections_;
+    std::vector<Connection> connections_;
+    std::vector<uint32_t> free_connections_;
+    std::vector<SendSlot> send_slots_;
+    std::vector<size_t> free_send_slots_;
+    std::condition_variable send_slot_cv_;
+};
+
+#endif //IN_TEST_IO_URING_TRANSPORT_HPP
@@ -0,0 +1,63 @@
+#include "Sharded_udp_agent.hpp"
+
+#include <algorithm>
+#include <string>
+
+ShardedUDPAgent::ShardedUDPAgent(
+        uint16_t port,
+        size_t shards,
+        eprosima::uxr::Middleware::Kind middleware_kind,
+        size_t batch_size,
+        std::chrono::microseconds flush_deadline)
+{
+    shards = std::max(shards, size_t(1));
+    for (size_t i = 0; i < shards; ++i)
+    {
+        transports_.emplace_back(new BatchedUDPTransport(port, batch_size, flush_deadline, shards));
+        endpoints_.emplace_back(new eprosima::uxr::CustomEndPoint());
+        BatchedUDPTransport::add_members(*endpoints_.back());
+
+        BatchedUDPTransport& transport = *transports_.back();
+        agents_.emplace_back(new eprosima::uxr::CustomAgent(
+            "sharded_udp_agent_" + std::to_string(i),
+            endpoints_.back().get(),
+            middleware_kind,
+            false,
+            transport.open,
+            transport.close,
+            transport.write,
+            transport.read));
+    }
+}
+
+bool ShardedUDPAgent::start()
+{
+    // Shards join the SO_REUSEPORT group in order, which makes the socket index the shard index.
+    for (auto& agent : agents_)
+    {
+        if (!agent->start())
+        {
+            stop();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShardedUDPAgent::stop()
+{
+    bool stopped = true;
+    for (auto& agent : agents_)
+    {
+        stopped = agent->stop() && stopped;
+    }
+    return stopped;
+}
+
+void ShardedUDPAgent::set_verbose_level(uint8_t verbose_level)
+{
+    for (auto& agent : agents_)
+    {
+        agent->set_verbose_level(verbose_level);
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef IN_TEST_SHARDED_UDP_AGENT_HPP
+#define IN_TEST_SHARDED_UDP_AGENT_HPP
+
+#include "Batched_udp_transport.hpp"
+
+#include <memory>
+#include <vector>
+
+/*
+ * UDP Agent made of one CustomAgent per shard, each one with its own SO_REUSEPORT socket on the
+ * same port and its own receive, processing and send threads (Linux only).
+ * The sockets are steered by client key, or source endpoint, so every session is only handled by
+ * the threads of one shard and its state is never shared across shards.
+ */
+class ShardedUDPAgent
+{
+public:
+    ShardedUDPAgent(
+            uint16_t port,
+            size_t shards,
+            eprosima::uxr::Middleware::Kind middleware_kind,
+            size_t batch_size = 32,
+            std::chrono::microseconds flush_deadline = std::chrono::microseconds(200));
+
+    ~ShardedUDPAgent()
+    {}
+
+    bool start();
+    bool stop();
+    void set_verbose_level(uint8_t verbose_level);
+
+    size_t get_shards() const
+    {
+        return agents_.size();
+    }
+
+    const BatchedUDPTransport& get_transport(size_t shard) const
+    {
+        return *transports_[shard];
+    }
+
+private:
+    // Declared before the Agents, which keep references to the callbacks and endpoints.
+    std::vector<std::unique_ptr<BatchedUDPTransport>> transports_;
+    std::vector<std::unique_ptr<eprosima::uxr::CustomEndPoint>> endpoints_;
+    std::vector<std::unique_ptr<eprosima::uxr::CustomAgent>> agents_;
+};
+
+#endif //IN_TEST_SHARDED_UDP_AGENT_HPP
@@ -0,0 +1,704 @@
+#include "Shared_memory_transport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const uint32_t SEGMENT_MAGIC = 0x55585253;
+static const size_t MAX_SLOTS = 0xFFFF;
+
+// Bytes of each ring, a power of two. A message takes its length prefix and is padded to 8 bytes.
+static const size_t RING_SIZE = 1 << 16;
+static const uint32_t WRAP_MARKER = UINT32_MAX;
+
+// Period of the Agent check for slots whose Client process is gone.
+static const std::chrono::seconds RECLAIM_PERIOD(1);
+
+enum SlotState : uint32_t
+{
+    FREE = 0,
+    CLAIMED,
+    CONNECTED,
+    CLOSING
+};
+
+static long futex(std::atomic<uint32_t>* word, int op, uint32_t value, const struct timespec* timeout)
+{
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout, nullptr, 0);
+}
+
+/*
+ * Futex word bumped on every message. A consumer reads the sequence, checks its rings and only
+ * then sleeps while the sequence is unchanged, so a message published in between is not missed.
+ */
+struct Doorbell
+{
+    std::atomic<uint32_t> sequence;
+    std::atomic<uint32_t> waiters;
+
+    void ring()
+    {
+        sequence.fetch_add(1);
+        if (0 < waiters.load())
+        {
+            futex(&sequence, FUTEX_WAKE, INT_MAX, nullptr);
+        }
+    }
+
+    void wait(uint32_t seen, int timeout)
+    {
+        struct timespec wait_time = {time_t(timeout / 1000), long(timeout % 1000) * 1000000L};
+        waiters.fetch_add(1);
+        futex(&sequence, FUTEX_WAIT, seen, &wait_time);
+        waiters.fetch_sub(1);
+    }
+};
+
+// Positions only grow, the offset in the ring is the position modulo RING_SIZE.
+struct RingControl
+{
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> head;
+};
+
+struct SlotControl
+{
+    alignas(64) std::atomic<uint32_t> state;
+    std::atomic<uint32_t> generation;
+    std::atomic<int32_t> owner;
+    RingControl to_agent;
+    RingControl to_client;
+    alignas(64) Doorbell client_doorbell;
+};
+
+// Followed by the slots, then the two rings of every slot.
+struct SharedMemorySegment
+{
+    uint32_t magic;
+    uint32_t slots;
+    alignas(64) Doorbell agent_doorbell;
+};
+
+static size_t segment_size(size_t slots)
+{
+    return sizeof(SharedMemorySegment) + slots * (sizeof(SlotControl) + 2 * RING_SIZE);
+}
+
+static SlotControl* slot_control(SharedMemorySegment* segment, uint32_t index)
+{
+    return reinterpret_cast<SlotControl*>(segment + 1) + index;
+}
+
+static uint8_t* ring_data(SharedMemorySegment* segment, uint32_t index, bool to_agent)
+{
+    uint8_t* rings = reinterpret_cast<uint8_t*>(slot_control(segment, segment->slots));
+    return rings + (2 * size_t(index) + (to_agent ? 0 : 1)) * RING_SIZE;
+}
+
+static uint32_t connection_id(uint32_t index, uint32_t generation)
+{
+    return ((generation & 0xFFFF) << 16) | index;
+}
+
+static size_t record_size(size_t length)
+{
+    return (sizeof(uint32_t) + length + 7) & ~size_t(7);
+}
+
+/*
+ * Producer side: room for a message of length bytes, and the position of its record, nullptr if
+ * the ring is full. A record never wraps, the end of the ring is skipped with a marker instead.
+ */
+static uint8_t* ring_reserve(RingControl& ring, uint8_t* data, size_t length, uint64_t& record)
+{
+    size_t size = record_size(length);
+    uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+    uint64_t head = ring.head.load(std::memory_order_acquire);
+    size_t offset = size_t(tail & (RING_SIZE - 1));
+    size_t skip = (RING_SIZE - offset < size) ? RING_SIZE - offset : 0;
+    if (RING_SIZE < size || RING_SIZE - size_t(tail - head) < skip + size)
+    {
+        return nullptr;
+    }
+
+    if (0 < skip)
+    {
+        std::memcpy(data + offset, &WRAP_MARKER, sizeof(WRAP_MARKER));
+        tail += skip;
+        offset = 0;
+    }
+    record = tail;
+    return data + offset + sizeof(uint32_t);
+}
+
+static void ring_commit(RingControl& ring, uint8_t* data, uint64_t record, size_t length)
+{
+    uint32_t prefix = uint32_t(length);
+    std::memcpy(data + size_t(record & (RING_SIZE - 1)), &prefix, sizeof(prefix));
+    ring.tail.store(record + record_size(length), std::memory_order_release);
+}
+
+/*
+ * Consumer side: the oldest message and the position following it, nullptr if the ring is empty.
+ * The producer may write anything to the shared memory, so a tail or a length prefix taking the
+ * message past the ring or past the tail flags the ring as corrupt instead.
+ */
+static const uint8_t* ring_peek(RingControl& ring, const uint8_t* data, size_t& length, uint64_t& next, bool& corrupt)
+{
+    corrupt = false;
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    uint64_t tail = ring.tail.load(std::memory_order_acquire);
+    if (head == tail)
+    {
+        return nullptr;
+    }
+    if (RING_SIZE < tail - head)
+    {
+        corrupt = true;
+        return nullptr;
+    }
+
+    size_t offset = size_t(head & (RING_SIZE - 1));
+    uint32_t prefix;
+    std::memcpy(&prefix, data + offset, sizeof(prefix));
+    if (WRAP_MARKER == prefix)
+    {
+        head += RING_SIZE - offset;
+        offset = 0;
+        if (tail <= head)
+        {
+            corrupt = true;
+            return nullptr;
+        }
+        std::memcpy(&prefix, data, sizeof(prefix));
+    }
+    if (RING_SIZE - offset - sizeof(uint32_t) < prefix || tail < head + record_size(prefix))
+    {
+        corrupt = true;
+        return nullptr;
+    }
+    length = prefix;
+    next = head + record_size(length);
+    return data + offset + sizeof(uint32_t);
+}
+
+static void ring_release(RingControl& ring, uint64_t next)
+{
+    ring.head.store(next, std::memory_order_release);
+}
+
+static int remaining_ms(std::chrono::steady_clock::time_point deadline)
+{
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return (0 < remaining.count()) ? int(remaining.count()) : 0;
+}
+
+SharedMemoryAgentTransport::SharedMemoryAgentTransport(
+        const std::string& name,
+        size_t slots)
+    : name_(name)
+    , slots_(std::min(std::max(slots, size_t(1)), MAX_SLOTS))
+    , fd_(-1)
+    , mapping_(MAP_FAILED)
+    , mapping_size_(segment_size(slots_))
+    , segment_(nullptr)
+    , send_mtx_(slots_)
+    , next_slot_(0)
+    , next_reclaim_(std::chrono::steady_clock::now())
+{
+    open = [this]() -> bool
+    {
+        return create_segment();
+    };
+
+    close = [this]() -> bool
+    {
+        return destroy_segment();
+    };
+
+    write = [this](
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return send(destination_endpoint, buffer, message_length, transport_rc);
+    };
+
+    read = [this](
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc) -> ssize_t
+    {
+        return recv(source_endpoint, buffer, buffer_length, timeout, transport_rc);
+    };
+}
+
+SharedMemoryAgentTransport::~SharedMemoryAgentTransport()
+{
+    destroy_segment();
+}
+
+void SharedMemoryAgentTransport::add_members(eprosima::uxr::CustomEndPoint& endpoint)
+{
+    try
+    {
+        endpoint.add_member<uint32_t>("connection");
+    }
+    catch(const std::exception& /*e*/)
+    {
+        // Already added by a previous Agent.
+    }
+}
+
+bool SharedMemoryAgentTransport::create_segment()
+{
+    // A segment left behind by a previous Agent is replaced.
+    shm_unlink(name_.c_str());
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (-1 == fd_)
+    {
+        return false;
+    }
+
+    if (-1 == ftruncate(fd_, off_t(mapping_size_)))
+    {
+        destroy_segment();
+        return false;
+    }
+
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (MAP_FAILED == mapping_)
+    {
+        destroy_segment();
+        return false;
+    }
+
+    segment_ = new (mapping_) SharedMemorySegment();
+    segment_->slots = uint32_t(slots_);
+    for (uint32_t i = 0; i < uint32_t(slots_); ++i)
+    {
+        new (slot_control(segment_, i)) SlotControl();
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    segment_->magic = SEGMENT_MAGIC;
+    next_slot_ = 0;
+
+    return true;
+}
+
+bool SharedMemoryAgentTransport::destroy_segment()
+{
+    if (-1 == fd_)
+    {
+        return true;
+    }
+
+    bool destroyed = true;
+    if (MAP_FAILED != mapping_)
+    {
+        destroyed = (0 == munmap(mapping_, mapping_size_));
+        mapping_ = MAP_FAILED;
+        segment_ = nullptr;
+    }
+    destroyed = (0 == ::close(fd_)) && destroyed;
+    destroyed = (0 == shm_unlink(name_.c_str())) && destroyed;
+    fd_ = -1;
+    return destroyed;
+}
+
+ssize_t SharedMemoryAgentTransport::recv(
+        eprosima::uxr::CustomEndPoint* source_endpoint,
+        uint8_t* buffer,
+        size_t buffer_length,
+        int timeout,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    for (;;)
+    {
+        uint32_t seen = segment_->agent_doorbell.sequence.load();
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (next_reclaim_ <= now)
+        {
+            reclaim_orphan_slots();
+            next_reclaim_ = now + RECLAIM_PERIOD;
+        }
+
+        // Round robin over the slots, starting after the last one served.
+        for (size_t n = 0; n < slots_; ++n)
+        {
+            uint32_t index = uint32_t((next_slot_ + n) % slots_);
+            SlotControl* slot = slot_control(segment_, index);
+            uint32_t state = slot->state.load(std::memory_order_acquire);
+            if (CLOSING == state)
+            {
+                release_slot(index);
+                continue;
+            }
+            if (CONNECTED != state)
+            {
+                continue;
+            }
+
+            size_t length;
+            uint64_t next;
+            bool corrupt;
+            const uint8_t* message = ring_peek(slot->to_agent, ring_data(segment_, index, true), length, next, corrupt);
+            if (corrupt)
+            {
+                // Nothing in the ring can be trusted anymore, the slot is closed as its Client would do.
+                uint32_t expected = CONNECTED;
+                slot->state.compare_exchange_strong(expected, CLOSING);
+                release_slot(index);
+                continue;
+            }
+            if (nullptr == message)
+            {
+                continue;
+            }
+
+            ssize_t rv = 0;
+            if (buffer_length < length)
+            {
+                transport_rc = eprosima::uxr::TransportRc::server_error;
+            }
+            else
+            {
+                std::memcpy(buffer, message, length);
+                source_endpoint->set_member_value<uint32_t>("connection", connection_id(index, slot->generation.load()));
+                rv = static_cast<ssize_t>(length);
+            }
+            ring_release(slot->to_agent, next);
+            next_slot_ = (index + 1) % slots_;
+            return rv;
+        }
+
+        int wait = remaining_ms(deadline);
+        if (0 == wait)
+        {
+            transport_rc = eprosima::uxr::TransportRc::timeout_error;
+            return 0;
+        }
+        segment_->agent_doorbell.wait(seen, std::min(wait, int(std::chrono::milliseconds(RECLAIM_PERIOD).count())));
+    }
+}
+
+ssize_t SharedMemoryAgentTransport::send(
+        const eprosima::uxr::CustomEndPoint* destination_endpoint,
+        uint8_t* buffer,
+        size_t message_length,
+        eprosima::uxr::TransportRc& transport_rc)
+{
+    uint32_t connection = destination_endpoint->get_member<uint32_t>("connection");
+    uint32_t index = connection & 0xFFFF;
+    if (slots_ <= index)
+    {
+        transport_rc = eprosima::uxr::TransportRc::connection_error;
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(send_mtx_[index]);
+    SlotControl* slot = slot_control(segment_, index);
+    if (CONNECTED != slot->state.load(std::memory_order_acquire)
+        || connection_id(index, slot->generation.load()) != connection)
+    {
+        transport_rc = eprosima::uxr::TransportRc::connection_error;
+        return 0;
+    }
+
+    uint8_t* data = ring_data(segment_, index, false);
+    uint64_t record;
+    uint8_t* message = ring_reserve(slot->to_client, data, message_length, record);
+    if (nullptr == message)
+    {
+        // Full, the message is dropped as a datagram would be.
+        transport_rc = eprosima::uxr::TransportRc::server_error;
+        return 0;
+    }
+
+    std::memcpy(message, buffer, message_length);
+    ring_commit(slot->to_client, data, record, message_length);
+    slot->client_doorbell.ring();
+
+    transport_rc = eprosima::uxr::TransportRc::ok;
+    return static_cast<ssize_t>(message_length);
+}
+
+void SharedMemoryAgentTransport::release_slot(uint32_t index)
+{
+    std::lock_guard<std::mutex> lock(send_mtx_[index]);
+    SlotControl* slot = slot_control(segment_, index);
+    slot->to_agent.head = 0;
+    slot->to_agent.tail = 0;
+    slot->to_client.head = 0;
+    slot->to_client.tail = 0;
+    slot->owner = 0;
+    slot->state.store(FREE, std::memory_order_release);
+}
+
+void SharedMemoryAgentTransport::reclaim_orphan_slots()
+{
+    // Clients are co-located and share the pid namespace of the Agent.
+    for (uint32_t i = 0; i < uint32_t(slots_); ++i)
+    {
+        SlotControl* slot = slot_control(segment_, i);
+        uint32_t state = slot->state.load();
+        int32_t owner = slot->owner.load();
+        if ((CLAIMED == state || CONNECTED == state) && 0 < owner && -1 == kill(pid_t(owner), 0) && ESRCH == errno)
+        {
+            slot->state.compare_exchange_strong(state, CLOSING);
+        }
+    }
+}
+
+SharedMemoryClient::SharedMemoryClient()
+    : fd_(-1)
+    , mapping_(MAP_FAILED)
+    , mapping_size_(0)
+    , segment_(nullptr)
+    , slot_(0)
+    , reserved_(0)
+{
+}
+
+SharedMemoryClient::~SharedMemoryClient()
+{
+    close();
+}
+
+bool SharedMemoryClient::open(const char* name)
+{
+    fd_ = shm_open(name, O_RDWR, 0);
+    if (-1 == fd_)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (-1 == fstat(fd_, &status) || size_t(status.st_size) < sizeof(SharedMemorySegment))
+    {
+        close();
+        return false;
+    }
+
+    mapping_size_ = size_t(status.st_size);
+    mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (MAP_FAILED == mapping_)
+    {
+        close();
+        return false;
+    }
+
+    segment_ = static_cast<SharedMemorySegment*>(mapping_);
+    if (SEGMENT_MAGIC != segment_->magic || mapping_size_ < segment_size(segment_->slots))
+    {
+        close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    for (uint32_t i = 0; i < segment_->slots; ++i)
+    {
+        SlotControl* slot = slot_control(segment_, i);
+        uint32_t expected = FREE;
+        if (slot->state.compare_exchange_strong(expected, CLAIMED))
+        {
+            slot->owner.store(int32_t(getpid()));
+            slot->generation.fetch_add(1);
+            slot->state.store(CONNECTED, std::memory_order_release);
+            slot_ = i;
+            return true;
+        }
+    }
+
+    close();
+    return false;
+}
+
+bool SharedMemoryClient::close()
+{
+    if (-1 == fd_)
+    {
+        return true;
+    }
+
+    bool closed = true;
+    if (MAP_FAILED != mapping_)
+    {
+        SlotControl* slot = slot_control(segment_, slot_);
+        if (SEGMENT_MAGIC == segment_->magic && CONNECTED == slot->state.load())
+        {
+            // The Agent empties the slot before giving it to another Client.
+            slot->state.store(CLOSING, std::memory_order_release);
+            segment_->agent_doorbell.ring();
+        }
+        closed = (0 == munmap(mapping_, mapping_size_));
+        mapping_ = MAP_FAILED;
+        segment_ = nullptr;
+    }
+    closed = (0 == ::close(fd_)) && closed;
+    fd_ = -1;
+    return closed;
+}
+
+uint8_t* SharedMemoryClient::reserve(size_t length)
+{
+    SlotControl* slot = slot_control(segment_, slot_);
+    return ring_reserve(slot->to_agent, ring_data(segment_, slot_, true), length, reserved_);
+}
+
+void SharedMemoryClient::commit(size_t length)
+{
+    SlotControl* slot = slot_control(segment_, slot_);
+    ring_commit(slot->to_agent, ring_data(segment_, slot_, true), reserved_, length);
+    segment_->agent_doorbell.ring();
+}
+
+size_t SharedMemoryClient::write(const uint8_t* buf, size_t len)
+{
+    uint8_t* message = reserve(len);
+    if (nullptr == message)
+    {
+        return 0;
+    }
+
+    std::memcpy(message, buf, len);
+    commit(len);
+    return len;
+}
+
+size_t SharedMemoryClient::writev(const custom_transport_slice* slices, size_t slice_count)
+{
+    size_t len = 0;
+    for (size_t i = 0; i < slice_count; ++i)
+    {
+        len += slices[i].length;
+    }
+
+    uint8_t* message = reserve(len);
+    if (nullptr == message)
+    {
+        return 0;
+    }
+
+    for (size_t i = 0, offset = 0; i < slice_count; offset += slices[i].length, ++i)
+    {
+        std::memcpy(message + offset, slices[i].data, slices[i].length);
+    }
+    commit(len);
+    return len;
+}
+
+size_t SharedMemoryClient::read(uint8_t* buf, size_t len, int timeout, uint8_t* errcode)
+{
+    SlotControl* slot = slot_control(segment_, slot_);
+    const uint8_t* data = ring_data(segment_, slot_, false);
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+    for (;;)
+    {
+        uint32_t seen = slot->client_doorbell.sequence.load();
+
+        size_t length;
+        uint64_t next;
+        bool corrupt;
+        const uint8_t* message = ring_peek(slot->to_client, data, length, next, corrupt);
+        if (corrupt)
+        {
+            *errcode = 1;
+            return 0;
+        }
+        if (nullptr != message)
+        {
+            size_t rv = 0;
+            if (len < length)
+            {
+                *errcode = 1;
+            }
+            else
+            {
+                std::memcpy(buf, message, length);
+                rv = length;
+            }
+            ring_release(slot->to_client, next);
+            return rv;
+        }
+
+        int wait = remaining_ms(deadline);
+        if (0 == wait)
+        {
+            return 0;
+        }
+        slot->client_doorbell.wait(seen, wait);
+    }
+}
+
+// Client custom transport
+extern "C"
+{
+    bool shared_memory_client_open(uxrCustomTransport* transport)
+    {
+        const char* name = static_cast<const char*>(transport->args);
+        SharedMemoryClient* client = new SharedMemoryClient();
+        if (!client->open(name))
+        {
+            delete client;
+            return false;
+        }
+
+        transport->args = client;
+        return true;
+    }
+
+    bool shared_memory_client_close(uxrCustomTransport* transport)
+    {
+        SharedMemoryClient* client = static_cast<SharedMemoryClient*>(transport->args);
+        bool closed = client->close();
+        delete client;
+        transport->args = nullptr;
+        return closed;
+    }
+
+    size_t shared_memory_client_write(uxrCustomTransport* transport, const uint8_t* buf, size_t len, uint8_t* errcode)
+    {
+        size_t rv = static_cast<SharedMemoryClient*>(transport->args)->write(buf, len);
+        if (0 == rv)
+        {
+            *errcode = 1;
+        }
+        return rv;
+    }
+
+    size_t shared_memory_client_writev(uxrCustomTransport* transport, const custom_transport_slice* slices, size_t slice_count, uint8_t* errcode)
+    {
+        size_t rv = static_cast<SharedMemoryClient*>(transport->args)->writev(slices, slice_count);
+        if (0 == rv)
+        {
+            *errcode = 1;
+        }
+        return rv;
+    }
+
+    size_t shared_memory_client_read(uxrCustomTransport* transport, uint8_t* buf, size_t len, int timeout, uint8_t* errcode)
+    {
+        return static_cast<SharedMemoryClient*>(transport->args)->read(buf, len, timeout, errcode);
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef IN_TEST_SHARED_MEMORY_TRANSPORT_HPP
+#define IN_TEST_SHARED_MEMORY_TRANSPORT_HPP
+
+#include <uxr/agent/transport/custom/CustomAgent.hpp>
+#include <uxr/client/profile/transport/custom/custom_transport.h>
+
+#include "Custom_transport_slice.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * Shared memory transport between co-located Clients and an Agent (Linux only).
+ *
+ * The Agent creates a POSIX shared memory segment with a number of client slots. A slot holds two
+ * lock-free single producer, single consumer rings of length-prefixed messages, one per direction.
+ * Consumers sleep on futexes in the segment, and producers only wake them when they are waiting:
+ * all the Clients ring the Agent doorbell, the Agent rings the doorbell of each slot.
+ *
+ * Every slot records the pid of its Client, and the Agent closes the slots whose Client exited without
+ * closing them. The Agent sends are serialized per slot to keep a single producer.
+ *
+ * A Client writer may serialize its message straight into the ring with reserve and commit. The custom
+ * transport callbacks are handed buffers already serialized, so they copy messages in and out of the rings.
+ */
+struct SharedMemorySegment;
+
+// Name of the segment of the Agent identified by port, as the IP transports are.
+inline std::string shared_memory_segment_name(uint16_t port)
+{
+    return "/uxr_test_shm_" + std::to_string(port);
+}
+
+class SharedMemoryAgentTransport
+{
+public:
+    SharedMemoryAgentTransport(
+            const std::string& name,
+            size_t slots = 16);
+
+    ~SharedMemoryAgentTransport();
+
+    // Member identifying a client on the CustomEndPoint: its slot and the generation of the slot.
+    static void add_members(eprosima::uxr::CustomEndPoint& endpoint);
+
+    eprosima::uxr::CustomAgent::InitFunction open;
+    eprosima::uxr::CustomAgent::FiniFunction close;
+    eprosima::uxr::CustomAgent::SendMsgFunction write;
+    eprosima::uxr::CustomAgent::RecvMsgFunction read;
+
+private:
+    bool create_segment();
+    bool destroy_segment();
+
+    ssize_t recv(
+            eprosima::uxr::CustomEndPoint* source_endpoint,
+            uint8_t* buffer,
+            size_t buffer_length,
+            int timeout,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    ssize_t send(
+            const eprosima::uxr::CustomEndPoint* destination_endpoint,
+            uint8_t* buffer,
+            size_t message_length,
+            eprosima::uxr::TransportRc& transport_rc);
+
+    // Empties the rings of a slot closed by its Client and makes it available again.
+    void release_slot(uint32_t index);
+
+    // Closes the slots of Clients that exited without closing them, found by their owner pid.
+    void reclaim_orphan_slots();
+
+    std::string name_;
+    size_t slots_;
+    int fd_;
+    void* mapping_;
+    size_t mapping_size_;
+    SharedMemorySegment* segment_;
+    std::vector<std::mutex> send_mtx_;
+    size_t next_slot_;
+    std::chrono::steady_clock::time_point next_reclaim_;
+};
+
+class SharedMemoryClient
+{
+public:
+    SharedMemoryClient();
+    ~SharedMemoryClient();
+
+    // Maps the segment of an Agent and takes one of its free slots.
+    bool open(const char* name);
+    bool close();
+
+    // Room to serialize a message of up to length bytes in place in the ring to the Agent, nullptr when it is full.
+    uint8_t* reserve(size_t length);
+
+    // Publishes the reserved message, with its serialized length, and wakes the Agent up.
+    void commit(size_t length);
+
+    size_t write(const uint8_t* buf, size_t len);
+
+    // Gathers the slices straight into the ring to the Agent, as one message.
+    size_t writev(const custom_transport_slice* slices, size_t slice_count);
+    size_t read(uint8_t* buf, size_t len, int timeout, uint8_t* errcode);
+
+private:
+    int fd_;
+    void* mapping_;
+    size_t mapping_size_;
+    SharedMemorySegment* segment_;
+    uint32_t slot_;
+    uint64_t reserved_;
+};
+
+// Client custom transport, the segment name is passed as the argument of uxr_init_custom_transport.
+extern "C"
+{
+    bool shared_memory_client_open(uxrCustomTransport* transport);
+    bool shared_memory_client_close(uxrCustomTransport* transport);
+    size_t shared_memory_client_write(uxrCustomTransport* transport, const uint8_t* buf, size_t len, uint8_t* errcode);
+    size_t shared_memory_client_writev(uxrCustomTransport* transport, const custom_transport_slice* slices, size_t slice_count, uint8_t* errcode);
+    size_t shared_memory_client_read(uxrCustomTransport* transport, uint8_t* buf, size_t len, int timeout, uint8_t* errcode);
+}
+
+#endif //IN_TEST_SHARED_MEMORY_TRANSPORT_HPP
@@ -5,6 +5,9 @@
 #include "Gateway.hpp"
 #include <EntitiesInfo.hpp>
 #include <../custom_transports/Custom_transports.hpp>
+#ifdef __linux__
+#include <../custom_transports/Shared_memory_transport.hpp>
+#endif
 
 #include <uxr/client/util/time.h>
 #include <uxr/client/client.h>
@@ -25,7 +28,15 @@ enum class Transport
     SERIAL_TRANSPORT,
     MULTISERIAL_TRANSPORT,
     CUSTOM_WITH_FRAMING,
-    CUSTOM_WITHOUT_FRAMING
+    CUSTOM_WITHOUT_FRAMING,
+    BATCHED_UDP_TRANSPORT,
+    SHARDED_UDP_TRANSPORT,
+    IO_URING_UDP_TRANSPORT,
+    IO_URING_TCP_TRANSPORT,
+    EPOLL_TCP_TRANSPORT,
+    SHARED_MEMORY_TRANSPORT,
+    EPOLL_MULTISERIAL_TRANSPORT,
+    BATCHED_CAN_TRANSPORT
 };
 
 enum class XRCECreationMode
@@ -62,6 +73,13 @@ public:
     {
     }
 
+    Client(const LinkModel& link, uint16_t history)
+    : gateway_(link)
+    , client_key_(++next_client_key_)
+    , history_(history)
+    {
+    }
+
     virtual ~Client()
     {}
 
@@ -364,11 +382,40 @@ public:
         return expected_topic_index_;
     }
 
+    const LinkStats& get_output_link_stats() const
+    {
+        return gateway_.get_output_stats();
+    }
+
+    const LinkStats& get_input_link_stats() const
+    {
+        return gateway_.get_input_stats();
+    }
+
+    void set_link_monitor(const LinkMonitor& monitor)
+    {
+        gateway_.set_monitor(monitor);
+    }
+
+    // Session ids below 128 carry the client key in every message header, set it before init_transport.
+    void set_session_id(uint8_t session_id)
+    {
+        session_id_ = session_id;
+    }
+
+    uint32_t get_client_key() const
+    {
+        return client_key_;
+    }
+
     void init_transport(Transport transport, const char* ip, const char* port)
     {
         switch(transport)
         {
             case Transport::UDP_IPV4_TRANSPORT:
+            case Transport::BATCHED_UDP_TRANSPORT:
+            case Transport::SHARDED_UDP_TRANSPORT:
+            case Transport::IO_URING_UDP_TRANSPORT:
                 mtu_ = UXR_CONFIG_UDP_TRANSPORT_MTU;
                 ASSERT_TRUE(uxr_init_udp_transport(&udp_transport_, UXR_IPv4, ip, port));
                 uxr_init_session(&session_, gateway_.monitorize(&udp_transport_.comm), client_key_);
@@ -379,6 +426,8 @@ public:
                 uxr_init_session(&session_, gateway_.monitorize(&udp_transport_.comm), client_key_);
                 break;
             case Transport::TCP_IPV4_TRANSPORT:
+            case Transport::IO_URING_TCP_TRANSPORT:
+            case Transport::EPOLL_TCP_TRANSPORT:
                 mtu_ = UXR_CONFIG_TCP_TRANSPORT_MTU;
                 ASSERT_TRUE(uxr_init_tcp_transport(&tcp_transport_, UXR_IPv4, ip, port));
                 uxr_init_session(&session_, gateway_.monitorize(&tcp_transport_.comm), client_key_);
@@ -416,6 +465,23 @@ public:
                 ASSERT_TRUE(uxr_init_custom_transport(&custom_transport_, NULL));
                 uxr_init_session(&session_, gateway_.monitorize(&custom_transport_.comm), client_key_);
                 break;
+#ifdef __linux__
+            case Transport::SHARED_MEMORY_TRANSPORT:
+                mtu_ = UXR_CONFIG_CUSTOM_TRANSPORT_MTU;
+
+                // The ip argument carries the name of the Agent segment.
+                uxr_set_custom_transport_callbacks(
+                    &custom_transport_,
+                    false,
+                    shared_memory_client_open,
+                    shared_memory_client_close,
+                    shared_memory_client_write,
+                    shared_memory_client_read);
+
+                ASSERT_TRUE(uxr_init_custom_transport(&custom_transport_, const_cast<char*>(ip)));
+                uxr_init_session(&session_, gateway_.monitorize(&custom_transport_.comm), client_key_);
+                break;
+#endif
             default:
                 FAIL() << "Transport type not supported";
                 break;
@@ -431,7 +497,7 @@ public:
 
         bool deleted = uxr_delete_session(&session_);
 
-        if(0.0f == gateway_.get_lost_value()) //because the agent only send one status to a delete in stream 0.
+        if(!gateway_.is_lossy()) //because the agent only send one status to a delete in stream 0.
         {
             EXPECT_TRUE(deleted);
             EXPECT_EQ(UXR_STATUS_OK, session_.info.last_requested_status);
@@ -441,14 +507,20 @@ public:
         {
             case Transport::UDP_IPV4_TRANSPORT:
             case Transport::UDP_IPV6_TRANSPORT:
+            case Transport::BATCHED_UDP_TRANSPORT:
+            case Transport::SHARDED_UDP_TRANSPORT:
+            case Transport::IO_URING_UDP_TRANSPORT:
                 ASSERT_TRUE(uxr_close_udp_transport(&udp_transport_));
                 break;
             case Transport::TCP_IPV4_TRANSPORT:
             case Transport::TCP_IPV6_TRANSPORT:
+            case Transport::IO_URING_TCP_TRANSPORT:
+            case Transport::EPOLL_TCP_TRANSPORT:
                 ASSERT_TRUE(uxr_close_tcp_transport(&tcp_transport_));
                 break;
             case Transport::CUSTOM_WITHOUT_FRAMING:
             case Transport::CUSTOM_WITH_FRAMING:
+            case Transport::SHARED_MEMORY_TRANSPORT:
                 ASSERT_TRUE(uxr_close_custom_transport(&custom_transport_));
                 break;
             default:
@@ -471,18 +543,24 @@ public:
         {
             case Transport::UDP_IPV4_TRANSPORT:
             case Transport::UDP_IPV6_TRANSPORT:
+            case Transport::BATCHED_UDP_TRANSPORT:
+            case Transport::SHARDED_UDP_TRANSPORT:
+            case Transport::IO_URING_UDP_TRANSPORT:
             {
                 comm = &udp_transport_.comm;
                 break;
             }
             case Transport::TCP_IPV4_TRANSPORT:
             case Transport::TCP_IPV6_TRANSPORT:
+            case Transport::IO_URING_TCP_TRANSPORT:
+            case Transport::EPOLL_TCP_TRANSPORT:
             {
                 comm = &tcp_transport_.comm;
                 break;
             }
             case Transport::CUSTOM_WITHOUT_FRAMING:
             case Transport::CUSTOM_WITH_FRAMING:
+            case Transport::SHARED_MEMORY_TRANSPORT:
             {
                 comm = &custom_transport_.comm;
                 break;
@@ -511,6 +589,7 @@ protected:
         uxr_set_status_callback(&session_, on_status_dispatcher, this);
 
         /* Create session. */
+        session_.info.id = session_id_;
         ASSERT_TRUE(uxr_create_session(&session_));
         ASSERT_EQ(UXR_STATUS_OK, session_.info.last_requested_status);
 
@@ -604,6 +683,7 @@ protected:
     Gateway gateway_;
 
     uint32_t client_key_;
+    uint8_t session_id_ = 0x81;
     uint16_t history_;
 
     uxrUDPTransport udp_transport_;
@@ -88,7 +88,7 @@ public:
 
         bool deleted = uxr_delete_session(&session_);
 
-        if(0.0f == gateway_.get_lost_value()) //because the agent only send one status to a delete in stream 0.
+        if(!gateway_.is_lossy()) //because the agent only send one status to a delete in stream 0.
         {
             EXPECT_TRUE(deleted);
             EXPECT_EQ(UXR_STATUS_OK, session_.info.last_requested_status);
@@ -4,17 +4,83 @@
 #include <iostream>
 #include <random>
 #include <chrono>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <vector>
 #include <uxr/client/core/communication/communication.h>
 
+/*
+ * Link model applied by the Gateway on both directions.
+ * The default value is a perfect link, which keeps the original pass-through behaviour.
+ */
+struct LinkModel
+{
+    std::chrono::microseconds delay{0};     // One-way propagation delay.
+    std::chrono::microseconds jitter{0};    // Uniform delay variation in [-jitter, +jitter].
+    uint32_t bandwidth = 0;                 // Bytes per second, 0 for unlimited.
+    float lost = 0.0f;                      // Loss probability in the good state.
+    float burst_enter = 0.0f;               // Gilbert-Elliott probability good -> bad.
+    float burst_exit = 1.0f;                // Gilbert-Elliott probability bad -> good.
+    float burst_lost = 1.0f;                // Loss probability in the bad state.
+    float duplicate = 0.0f;                 // Duplication probability.
+    float reorder = 0.0f;                   // Probability of holding a message back one extra delay.
+    uint32_t seed = 0;                      // 0 for a random seed.
+
+    bool is_perfect() const
+    {
+        return delay.count() == 0 && jitter.count() == 0 && bandwidth == 0
+            && burst_enter == 0.0f && duplicate == 0.0f && reorder == 0.0f;
+    }
+};
+
+struct LinkStats
+{
+    uint64_t messages = 0;
+    uint64_t bytes = 0;
+    uint64_t lost = 0;
+    uint64_t duplicated = 0;
+    uint64_t reordered = 0;
+    uint64_t retransmissions = 0;           // Reliable messages seen again with an old sequence number.
+};
+
+enum class LinkDirection
+{
+    OUTPUT,
+    INPUT
+};
+
+/*
+ * Called for every message crossing the Gateway, before the link model is applied.
+ */
+using LinkMonitor = std::function<void(LinkDirection direction, const uint8_t* buf, size_t len, bool retransmission)>;
+
 class Gateway
 {
 public:
     Gateway(float lost)
+    : Gateway(make_lost_model(lost))
+    {
+    }
+
+    Gateway(const LinkModel& model)
     : user_comm_(nullptr)
-    , lost_(lost)
+    , lost_(model.lost)
+    , model_(model)
     {
-        std::random_device rd;
-        random_.seed(rd());
+        output_.direction = LinkDirection::OUTPUT;
+        input_.direction = LinkDirection::INPUT;
+
+        if(0 == model.seed)
+        {
+            std::random_device rd;
+            random_.seed(rd());
+        }
+        else
+        {
+            random_.seed(model.seed);
+        }
     }
 
     virtual ~Gateway()
@@ -38,10 +104,62 @@ public:
         return lost_;
     }
 
+    // Whether the link may drop, duplicate or reorder messages.
+    bool is_lossy() const
+    {
+        return 0.0f != lost_ || (0.0f != model_.burst_enter && 0.0f != model_.burst_lost)
+            || 0.0f != model_.duplicate || 0.0f != model_.reorder;
+    }
+
+    const LinkModel& get_link_model() const
+    {
+        return model_;
+    }
+
+    const LinkStats& get_output_stats() const
+    {
+        return output_.stats;
+    }
+
+    const LinkStats& get_input_stats() const
+    {
+        return input_.stats;
+    }
+
+    void set_monitor(const LinkMonitor& monitor)
+    {
+        monitor_ = monitor;
+    }
+
 private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Message
+    {
+        Clock::time_point release;
+        std::vector<uint8_t> data;
+    };
+
+    struct Link
+    {
+        LinkDirection direction;
+        std::deque<Message> queue;
+        Clock::time_point busy_until;
+        bool bad_state = false;
+        std::map<uint8_t, uint16_t> last_seq;
+        LinkStats stats;
+    };
+
     static const size_t MESSAGE_LENGTH = 4096;
     static std::uniform_real_distribution<float> msg_lost_;
 
+    static LinkModel make_lost_model(float lost)
+    {
+        LinkModel model;
+        model.lost = lost;
+        return model;
+    }
+
     static bool send_dispatcher(void* instance, const uint8_t* buf, size_t len)
     {
         return static_cast<Gateway*>(instance)->send(buf, len);
@@ -54,8 +172,15 @@ private:
 
     bool send(const uint8_t* buf, size_t len)
     {
+        if(!model_.is_perfect())
+        {
+            return emulated_send(buf, len);
+        }
+
+        account(output_, buf, len);
         if(get_lost())
         {
+            ++output_.stats.lost;
             std::cout << "[Message from client lost -> " << len << " bytes lost]" << std::endl;
             return false;
         }
@@ -65,6 +190,11 @@ private:
 
     bool recv(uint8_t** buf, size_t* len, int timeout)
     {
+        if(!model_.is_perfect())
+        {
+            return emulated_recv(buf, len, timeout);
+        }
+
         int poll = timeout;
         do
         {
@@ -75,8 +205,10 @@ private:
 
             if(result)
             {
+                account(input_, *buf, *len);
                 if(get_lost())
                 {
+                    ++input_.stats.lost;
                     std::cout << "[Message from agent lost -> " << *len << " bytes lost]" << std::endl;
                 }
                 else
@@ -90,6 +222,166 @@ private:
         return false;
     }
 
+    bool emulated_send(const uint8_t* buf, size_t len)
+    {
+        account(output_, buf, len);
+        if(get_lost(output_))
+        {
+            ++output_.stats.lost;
+            return false;
+        }
+
+        enqueue(output_, buf, len);
+        flush_output(Clock::now());
+        return true;
+    }
+
+    bool emulated_recv(uint8_t** buf, size_t* len, int timeout)
+    {
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeout);
+        while(true)
+        {
+            Clock::time_point now = Clock::now();
+            flush_output(now);
+
+            if(!input_.queue.empty() && input_.queue.front().release <= now)
+            {
+                delivered_ = std::move(input_.queue.front().data);
+                input_.queue.pop_front();
+                *buf = delivered_.data();
+                *len = delivered_.size();
+                return true;
+            }
+
+            Clock::time_point wake = deadline;
+            if(!output_.queue.empty() && output_.queue.front().release < wake)
+            {
+                wake = output_.queue.front().release;
+            }
+            if(!input_.queue.empty() && input_.queue.front().release < wake)
+            {
+                wake = input_.queue.front().release;
+            }
+
+            int wait = 0;
+            if(wake > now)
+            {
+                auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(wake - now).count();
+                wait = static_cast<int>((remaining + 999) / 1000);
+            }
+
+            uint8_t* in_buf;
+            size_t in_len;
+            if(user_comm_->recv_msg(user_comm_->instance, &in_buf, &in_len, wait))
+            {
+                account(input_, in_buf, in_len);
+                if(get_lost(input_))
+                {
+                    ++input_.stats.lost;
+                }
+                else
+                {
+                    enqueue(input_, in_buf, in_len);
+                }
+            }
+
+            if(Clock::now() >= deadline && (input_.queue.empty() || input_.queue.front().release > Clock::now()))
+            {
+                break;
+            }
+        }
+
+        return false;
+    }
+
+    void flush_output(Clock::time_point now)
+    {
+        while(!output_.queue.empty() && output_.queue.front().release <= now)
+        {
+            const std::vector<uint8_t>& data = output_.queue.front().data;
+            user_comm_->send_msg(user_comm_->instance, data.data(), data.size());
+            output_.queue.pop_front();
+        }
+    }
+
+    void enqueue(Link& link, const uint8_t* buf, size_t len)
+    {
+        Clock::time_point now = Clock::now();
+
+        // Serialization time on a bandwidth capped link, messages wait for the previous ones.
+        Clock::time_point start = (link.busy_until > now) ? link.busy_until : now;
+        if(0 != model_.bandwidth)
+        {
+            link.busy_until = start + std::chrono::microseconds(uint64_t(len) * 1000000 / model_.bandwidth);
+        }
+        else
+        {
+            link.busy_until = start;
+        }
+
+        Clock::time_point release = link.busy_until + model_.delay;
+        if(0 != model_.jitter.count())
+        {
+            std::uniform_int_distribution<int64_t> jitter(-model_.jitter.count(), model_.jitter.count());
+            release += std::chrono::microseconds(jitter(random_));
+            release = (release < now) ? now : release;
+        }
+
+        if(msg_lost_(random_) < model_.reorder)
+        {
+            ++link.stats.reordered;
+            release += model_.delay + model_.jitter + std::chrono::milliseconds(1);
+        }
+
+        insert(link, release, buf, len);
+
+        if(msg_lost_(random_) < model_.duplicate)
+        {
+            ++link.stats.duplicated;
+            insert(link, release, buf, len);
+        }
+    }
+
+    void insert(Link& link, Clock::time_point release, const uint8_t* buf, size_t len)
+    {
+        Message message{release, std::vector<uint8_t>(buf, buf + len)};
+        auto it = link.queue.end();
+        while(it != link.queue.begin() && std::prev(it)->release > release)
+        {
+            --it;
+        }
+        link.queue.insert(it, std::move(message));
+    }
+
+    void account(Link& link, const uint8_t* buf, size_t len)
+    {
+        ++link.stats.messages;
+        link.stats.bytes += len;
+
+        // Message header: session_id, stream_id, sequence number (little endian).
+        bool retransmission = false;
+        if(4 <= len && 0 != (buf[1] & 0x80))
+        {
+            uint8_t stream_id = buf[1];
+            uint16_t seq = uint16_t(buf[2] | (buf[3] << 8));
+            auto it = link.last_seq.find(stream_id);
+            if(it == link.last_seq.end() || 0 < int16_t(seq - it->second))
+            {
+                link.last_seq[stream_id] = seq;
+            }
+            else
+            {
+                retransmission = true;
+                ++link.stats.retransmissions;
+            }
+        }
+
+        if(monitor_)
+        {
+            monitor_(link.direction, buf, len, retransmission);
+        }
+    }
+
     bool get_lost()
     {
         if(msg_lost_(random_) < lost_)
@@ -100,12 +392,31 @@ private:
         return false;
     }
 
+    bool get_lost(Link& link)
+    {
+        if(link.bad_state)
+        {
+            link.bad_state = !(msg_lost_(random_) < model_.burst_exit);
+        }
+        else
+        {
+            link.bad_state = msg_lost_(random_) < model_.burst_enter;
+        }
+
+        return msg_lost_(random_) < (link.bad_state ? model_.burst_lost : lost_);
+    }
+
     std::mt19937 random_;
 
     uxrCommunication* user_comm_;
     uxrCommunication communication_;
 
     float lost_;
+    LinkModel model_;
+    Link output_;
+    Link input_;
+    std::vector<uint8_t> delivered_;
+    LinkMonitor monitor_;
 };
 
 #endif //IN_TEST_GATEWAY
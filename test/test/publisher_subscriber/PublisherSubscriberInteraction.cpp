@@ -19,6 +19,19 @@ public:
     {
     }
 
+    PubSub(std::tuple<Transport, MiddlewareKind, float, XRCECreationMode> parameters,
+          const LinkModel& link,
+          const uint16_t AGENT_PORT,
+          uint8_t id)
+        : Client(link, 8)
+        , transport_(std::get<0>(parameters))
+        , middleware_(std::get<1>(parameters))
+        , creation_mode_(std::get<3>(parameters))
+        , AGENT_PORT_(AGENT_PORT)
+        , id_(id)
+    {
+    }
+
     ~PubSub()
     {}
 
@@ -28,6 +41,11 @@ public:
         {
             case Transport::UDP_IPV4_TRANSPORT:
             case Transport::TCP_IPV4_TRANSPORT:
+            case Transport::BATCHED_UDP_TRANSPORT:
+            case Transport::SHARDED_UDP_TRANSPORT:
+            case Transport::IO_URING_UDP_TRANSPORT:
+            case Transport::IO_URING_TCP_TRANSPORT:
+            case Transport::EPOLL_TCP_TRANSPORT:
             {
                 ASSERT_NO_FATAL_FAILURE(Client::init_transport(transport_, "127.0.0.1", std::to_string(AGENT_PORT_).c_str()));
                 break;
@@ -45,6 +63,15 @@ public:
                 ASSERT_NO_FATAL_FAILURE(Client::init_transport(transport_, NULL, NULL));
                 break;
             }
+#ifdef __linux__
+            case Transport::SHARED_MEMORY_TRANSPORT:
+            {
+                ASSERT_NO_FATAL_FAILURE(Client::init_transport(transport_, shared_memory_segment_name(AGENT_PORT_).c_str(), NULL));
+                break;
+            }
+#endif
+            default:
+                break;
         }
 
         if (creation_mode_ == XRCECreationMode::XRCE_XML_CREATION)
@@ -241,6 +268,46 @@ GTEST_INSTANTIATE_TEST_MACRO(
         ::testing::Values(0.0f),
         ::testing::Values(XRCECreationMode::XRCE_XML_CREATION)));
 
+#ifdef __linux__
+GTEST_INSTANTIATE_TEST_MACRO(
+    TransportAndLostBatchedTransports,
+    PublisherSubscriberNoLost,
+    ::testing::Combine(
+        ::testing::Values(Transport::BATCHED_UDP_TRANSPORT, Transport::SHARDED_UDP_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED),
+        ::testing::Values(0.0f),
+        ::testing::Values(XRCECreationMode::XRCE_XML_CREATION)));
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    TransportAndLostEpollTransports,
+    PublisherSubscriberNoLost,
+    ::testing::Combine(
+        ::testing::Values(Transport::EPOLL_TCP_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED),
+        ::testing::Values(0.0f),
+        ::testing::Values(XRCECreationMode::XRCE_XML_CREATION)));
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    TransportAndLostSharedMemoryTransports,
+    PublisherSubscriberNoLost,
+    ::testing::Combine(
+        ::testing::Values(Transport::SHARED_MEMORY_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED),
+        ::testing::Values(0.0f),
+        ::testing::Values(XRCECreationMode::XRCE_XML_CREATION)));
+#endif // __linux__
+
+#ifdef UXR_TEST_IO_URING
+GTEST_INSTANTIATE_TEST_MACRO(
+    TransportAndLostIoUringTransports,
+    PublisherSubscriberNoLost,
+    ::testing::Combine(
+        ::testing::ValuesIn(io_uring_transports()),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED),
+        ::testing::Values(0.0f),
+        ::testing::Values(XRCECreationMode::XRCE_XML_CREATION)));
+#endif // UXR_TEST_IO_URING
+
 TEST_P(PublisherSubscriberLost, PubSub1FragmentedTopic2Parts)
 {
     std::string message(size_t(publisher_.get_mtu() * 1.5), 'A');
@@ -274,6 +341,97 @@ GTEST_INSTANTIATE_TEST_MACRO(
         ::testing::Values(0.05f, 0.1f),
         ::testing::Values(XRCECreationMode::XRCE_XML_CREATION)));
 
+class PublisherSubscriberLink : public ::testing::TestWithParam<std::tuple<Transport, MiddlewareKind, float, XRCECreationMode>>
+{
+public:
+    const uint16_t AGENT_PORT = 2018 + uint16_t(std::get<0>(this->GetParam()));
+
+    PublisherSubscriberLink()
+        : transport_(std::get<0>(GetParam()))
+        , agent_(transport_, (MiddlewareKind) std::get<1>(GetParam()), AGENT_PORT)
+        , publisher_(GetParam(), radio_link(1), AGENT_PORT, 1)
+        , subscriber_(GetParam(), radio_link(2), AGENT_PORT, 1)
+    {
+        agent_.start();
+    }
+
+    ~PublisherSubscriberLink()
+    {}
+
+    void SetUp() override
+    {
+        publisher_.init();
+        subscriber_.init();
+    }
+
+    void TearDown() override
+    {
+        ASSERT_NO_FATAL_FAILURE(publisher_.close());
+        ASSERT_NO_FATAL_FAILURE(subscriber_.close());
+    }
+
+    // Low-rate radio link: 20 ms +- 5 ms delay, 32 kB/s, bursty losses, some duplicates and reordering.
+    static LinkModel radio_link(uint32_t seed)
+    {
+        LinkModel link;
+        link.delay = std::chrono::milliseconds(20);
+        link.jitter = std::chrono::milliseconds(5);
+        link.bandwidth = 32 * 1024;
+        link.lost = std::get<2>(GetParam());
+        link.burst_enter = 0.02f;
+        link.burst_exit = 0.3f;
+        link.burst_lost = 0.8f;
+        link.duplicate = 0.01f;
+        link.reorder = 0.02f;
+        link.seed = seed;
+        return link;
+    }
+
+    void check_messages(std::string message, size_t number, uint8_t stream_id_raw)
+    {
+        int64_t start_time = uxr_millis();
+
+        std::thread publisher_thread(&Client::publish, &publisher_, 1, stream_id_raw, number, message);
+        std::thread subscriber_thread(&Client::subscribe, &subscriber_, 1, stream_id_raw, number, message);
+
+        publisher_thread.join();
+        subscriber_thread.join();
+
+        ::testing::Test::RecordProperty("recovery_ms", int(uxr_millis() - start_time));
+        ::testing::Test::RecordProperty("publisher_retransmissions", int(publisher_.get_output_link_stats().retransmissions));
+        ::testing::Test::RecordProperty("publisher_lost", int(publisher_.get_output_link_stats().lost));
+        ::testing::Test::RecordProperty("subscriber_lost", int(subscriber_.get_input_link_stats().lost));
+    }
+
+protected:
+    Transport transport_;
+    Agent agent_;
+    PubSub publisher_;
+    PubSub subscriber_;
+};
+
+TEST_P(PublisherSubscriberLink, PubSub10TopicsReliable)
+{
+    std::this_thread::sleep_for(std::chrono::seconds(2)); // Waiting for matching.
+    check_messages("Hello DDS world!", 10, 0x80);
+}
+
+TEST_P(PublisherSubscriberLink, PubSub3FragmentedTopic4Parts)
+{
+    std::this_thread::sleep_for(std::chrono::seconds(2)); // Waiting for matching.
+    std::string message(size_t(publisher_.get_mtu() * 3.5), 'A');
+    check_messages(message, 3, 0x80);
+}
+
+GTEST_INSTANTIATE_TEST_MACRO(
+    RadioLink,
+    PublisherSubscriberLink,
+    ::testing::Combine(
+        ::testing::Values(Transport::UDP_IPV4_TRANSPORT),
+        ::testing::Values(MiddlewareKind::CED),
+        ::testing::Values(0.0f, 0.05f),
+        ::testing::Values(XRCECreationMode::XRCE_XML_CREATION)));
+
 
 int main(int args, char** argv)
 {
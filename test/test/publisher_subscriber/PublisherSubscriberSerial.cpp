@@ -27,6 +27,7 @@ public:
         {
             case Transport::SERIAL_TRANSPORT:
             case Transport::MULTISERIAL_TRANSPORT:
+            case Transport::EPOLL_MULTISERIAL_TRANSPORT:
                 grantpt(masterfd_);
                 unlockpt(masterfd_);
                 ASSERT_NO_FATAL_FAILURE(ClientSerial::init_transport(transport_, ptsname(masterfd_), NULL));
@@ -173,3 +174,14 @@ GTEST_INSTANTIATE_TEST_MACRO(
         ::testing::Values(MiddlewareKind::FASTDDS),
         ::testing::Values(0.0f),
         ::testing::Values(XRCECreationMode::XRCE_BIN_CREATION)));
+
+#ifdef __linux__
+GTEST_INSTANTIATE_TEST_MACRO(
+    EpollMultiSerialPubSubBin,
+    PublisherSubscriberSerial,
+    ::testing::Combine(
+        ::testing::Values(Transport::EPOLL_MULTISERIAL_TRANSPORT),
+        ::testing::Values(MiddlewareKind::FASTDDS, MiddlewareKind::CED),
+        ::testing::Values(0.0f),
+        ::testing::Values(XRCECreationMode::XRCE_BIN_CREATION)));
+#endif // __linux__